@@ -16,23 +16,1491 @@ Copy code
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <climits>
+#include <string>
+#include <fstream>
+#include <bit>
+#include <cstring>
+#include <charconv>
+#include <cmath>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+#include <random>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
-// Represent sparse matrix using a map of maps
-class SparseMatrix {
+// Read-only view of compressed sparse row (CSR) arrays, which may live in a
+// CsrSnapshot or directly in a memory-mapped graph file.
+// Row r belongs to user ids[r]; its friends are the rows stored in
+// neighbors[offsets[r]] .. neighbors[offsets[r + 1] - 1], sorted ascending.
+// Rows follow id order unless the graph was relabeled for locality; then byId
+// lists the rows in id order, so user ids can still be looked up.
+struct CsrView {
+    const int* ids = nullptr;           // Row -> user id
+    const uint64_t* offsets = nullptr;  // Row r spans [offsets[r], offsets[r + 1])
+    const int* neighbors = nullptr;     // Friend rows, contiguous and sorted per row
+    int rowCount = 0;
+    const int* byId = nullptr;          // Rows sorted by user id, or nullptr if ids is sorted
+
+    int rows() const { return rowCount; }
+    uint64_t edges() const { return rowCount ? offsets[rowCount] : 0; }
+    uint64_t degree(int row) const { return offsets[row + 1] - offsets[row]; }
+
+    // Row of a user, or -1 if the user is not in the graph
+    int rowOf(int user) const {
+        if (byId) {
+            const int* it = lower_bound(byId, byId + rowCount, user, [&](int row, int id) { return ids[row] < id; });
+            return (it != byId + rowCount && ids[*it] == user) ? *it : -1;
+        }
+        const int* it = lower_bound(ids, ids + rowCount, user);
+        if (it == ids + rowCount || *it != user) return -1;
+        return it - ids;
+    }
+
+    const int* rowBegin(int row) const { return neighbors + offsets[row]; }
+    const int* rowEnd(int row) const { return neighbors + offsets[row + 1]; }
+
+    // Galloping search in the sorted range [lo, last): jump 1, 2, 4, ... entries ahead,
+    // then binary search the last jump. Returns the first entry not less than `target`.
+    static const int* gallop(const int* lo, const int* last, int target) {
+        size_t step = 1;
+        while (lo + step < last && lo[step] < target) {
+            lo += step;
+            step *= 2;
+        }
+        const int* hi = (lo + step + 1 < last) ? lo + step + 1 : last;
+        return lower_bound(lo, hi, target);
+    }
+
+    // Entry of `target` in the row, or nullptr
+    const int* findInRow(int row, int target) const {
+        const int* last = rowEnd(row);
+        const int* at = gallop(rowBegin(row), last, target);
+        return (at != last && *at == target) ? at : nullptr;
+    }
+
+    bool rowContains(int row, int target) const { return findInRow(row, target) != nullptr; }
+};
+
+// Compressed sparse row (CSR) snapshot of the friend graph, owning its arrays
+struct CsrSnapshot {
+    vector<int> ids;
+    vector<uint64_t> offsets;
+    vector<int> neighbors;
+    vector<int> byId;  // Rows sorted by user id; empty while ids itself is sorted
+
+    CsrView view() const {
+        return {ids.data(), offsets.data(), neighbors.data(), rows(), byId.empty() ? nullptr : byId.data()};
+    }
+    int rows() const { return ids.size(); }
+    uint64_t edges() const { return neighbors.size(); }
+    uint64_t degree(int row) const { return offsets[row + 1] - offsets[row]; }
+    int rowOf(int user) const { return view().rowOf(user); }
+    bool rowContains(int row, int target) const { return view().rowContains(row, target); }
+
+    // Rebuild byId after ids changed
+    void indexIds() {
+        byId.clear();
+        if (is_sorted(ids.begin(), ids.end())) return;
+        byId.resize(ids.size());
+        iota(byId.begin(), byId.end(), 0);
+        sort(byId.begin(), byId.end(), [&](int a, int b) { return ids[a] < ids[b]; });
+    }
+};
+
+// Row orders for relabeling a graph so that rows used together sit together in memory
+enum class RowOrder {
+    Id,                   // Ascending user id (the layout freeze() builds)
+    Degree,               // Most friends first, so the busiest rows share cache lines
+    Bfs,                  // Breadth-first, one connected component after another
+    ReverseCuthillMcKee,  // BFS from a low-degree row visiting neighbors by degree, reversed
+};
+
+// New row order for a graph: result[newRow] = oldRow
+vector<int> localityOrder(CsrView g, RowOrder order) {
+    int n = g.rows();
+    vector<int> result(n);
+    iota(result.begin(), result.end(), 0);
+    auto byDegree = [&](int a, int b) { return g.degree(a) < g.degree(b); };
+    if (order == RowOrder::Id) {
+        sort(result.begin(), result.end(), [&](int a, int b) { return g.ids[a] < g.ids[b]; });
+    } else if (order == RowOrder::Degree) {
+        stable_sort(result.begin(), result.end(), [&](int a, int b) { return g.degree(a) > g.degree(b); });
+    } else {
+        // Cuthill-McKee starts each component at a low-degree row and keeps the
+        // rows discovered from one row sorted by degree; reversing the whole order
+        // gives RCM, which narrows the band of the adjacency matrix further
+        bool rcm = order == RowOrder::ReverseCuthillMcKee;
+        vector<int> starts = result;
+        if (rcm) stable_sort(starts.begin(), starts.end(), byDegree);
+        vector<char> seen(n, 0);
+        result.clear();
+        for (int start : starts) {
+            if (seen[start]) continue;
+            seen[start] = 1;
+            result.push_back(start);
+            for (size_t head = result.size() - 1; head < result.size(); ++head) {
+                size_t discovered = result.size();
+                int u = result[head];
+                for (uint64_t k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.neighbors[k];
+                    if (!seen[v]) seen[v] = 1, result.push_back(v);
+                }
+                if (rcm) stable_sort(result.begin() + discovered, result.end(), byDegree);
+            }
+        }
+        if (rcm) reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+// Rewrite a CSR graph in a new row order (newToOld[newRow] = oldRow). Users keep
+// their ids; only the rows move. If sourceEntry is given it receives the old entry
+// index of every new entry, so per-edge values can be permuted alongside.
+CsrSnapshot permuteRows(CsrView g, span<const int> newToOld, vector<uint64_t>* sourceEntry = nullptr) {
+    int n = g.rows();
+    vector<int> oldToNew(n);
+    for (int r = 0; r < n; ++r) oldToNew[newToOld[r]] = r;
+
+    CsrSnapshot result;
+    result.ids.resize(n);
+    result.offsets.reserve(n + 1);
+    result.offsets.push_back(0);
+    result.neighbors.reserve(g.edges());
+    if (sourceEntry) sourceEntry->assign(0, 0), sourceEntry->reserve(g.edges());
+    vector<pair<int, uint64_t>> row;  // (new friend row, old entry)
+    for (int r = 0; r < n; ++r) {
+        int old = newToOld[r];
+        result.ids[r] = g.ids[old];
+        row.clear();
+        for (uint64_t k = g.offsets[old]; k < g.offsets[old + 1]; ++k) row.push_back({oldToNew[g.neighbors[k]], k});
+        sort(row.begin(), row.end());
+        for (const auto& [friendRow, entry] : row) {
+            result.neighbors.push_back(friendRow);
+            if (sourceEntry) sourceEntry->push_back(entry);
+        }
+        result.offsets.push_back(result.neighbors.size());
+    }
+    result.indexIds();
+    return result;
+}
+
+// Hardware cache-miss counter for the calling thread, using Linux perf events.
+// valid() is false where counting is not available (other systems, or a kernel
+// or container that does not allow perf_event_open).
+class CacheMissCounter {
 public:
-    unordered_map<int, unordered_map<int, int>> data;
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr = {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+    ~CacheMissCounter() {
+        if (fd != -1) ::close(fd);
+    }
 
-    void addConnection(int user1, int user2) {
-        data[user1][user2] = 1;
-        data[user2][user1] = 1;  // Undirected graph
+    bool valid() const { return fd != -1; }
+
+    void start() {
+#ifdef __linux__
+        if (fd == -1) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
     }
 
-    bool isConnected(int user1, int user2) {
-        return data[user1].count(user2) > 0;
+    // Misses since start(), or 0 if counting is not available
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd == -1) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) return 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd = -1;
+};
+
+// Run body(worker, begin, end) over [0, count) on up to `threads` threads.
+// Workers claim fixed-size chunks from a shared counter, so a thread that
+// finishes early keeps taking chunks that would otherwise wait for a busy one.
+template <typename Body>
+void parallelChunks(size_t count, unsigned threads, Body body) {
+    const size_t chunk = 1024;
+    if (threads <= 1 || count <= chunk) {
+        body(0u, size_t(0), count);  // Small inputs are cheaper inline
+        return;
+    }
+    atomic<size_t> nextChunk{0};
+    auto worker = [&](unsigned id) {
+        for (size_t begin; (begin = nextChunk.fetch_add(chunk)) < count;)
+            body(id, begin, min(begin + chunk, count));
+    };
+    vector<thread> pool;
+    for (unsigned id = 1; id < threads; ++id) pool.emplace_back(worker, id);
+    worker(0);
+    for (auto& t : pool) t.join();
+}
+
+// Run work(worker) once on each of `workers` threads (worker 0 is the caller)
+template <typename Work>
+void runWorkers(unsigned workers, Work work) {
+    vector<thread> pool;
+    for (unsigned id = 1; id < workers; ++id) pool.emplace_back(work, id);
+    work(0u);
+    for (auto& t : pool) t.join();
+}
+
+// Direction-optimizing BFS over a CSR snapshot. A level is expanded top-down
+// (frontier rows push to their neighbors) while the frontier is small, and
+// bottom-up (every unvisited row looks for a parent in the frontier bitmap)
+// once the frontier's edges outnumber the unexplored edges / alpha.
+// The visited bitmap is kept between runs until reset() or clear(), so repeated
+// runs from unvisited rows label connected components in O(rows + edges) total.
+class BfsEngine {
+public:
+    vector<int> hops;  // Hop distance of each row from its run's source, -1 = not reached
+
+    explicit BfsEngine(CsrView graph, unsigned threads = thread::hardware_concurrency())
+        : g(graph), workers(max(threads, 1u)), visited(words()), frontierBits(words()), local(workers) {
+        reset();
+    }
+
+    void reset() {
+        hops.assign(g.rows(), -1);
+        for (auto& word : visited) word.store(0, memory_order_relaxed);
+        touched.clear();
+        unexploredEdges = g.edges();
+    }
+
+    // Same as reset(), but only undoes the rows reached since then, so a short run
+    // on a large graph costs what it reaches instead of O(rows)
+    void clear() {
+        for (int r : touched) {
+            hops[r] = -1;
+            visited[r >> 6].store(0, memory_order_relaxed);  // Every set bit in the word is touched too
+        }
+        touched.clear();
+        unexploredEdges = g.edges();
+    }
+
+    // Whether this engine was built for the same layout and worker count
+    bool serves(CsrView graph, unsigned threads) const {
+        return graph.ids == g.ids && graph.offsets == g.offsets && graph.neighbors == g.neighbors &&
+               graph.rowCount == g.rowCount && graph.byId == g.byId && max(threads, 1u) == workers;
+    }
+
+    // BFS from `source` over rows not visited yet. Stops after maxHops levels, or after
+    // the level that reaches stopRow. Returns the reached rows in level order.
+    const vector<int>& run(int source, int maxHops = INT_MAX, int stopRow = -1) {
+        reached.clear();
+        if (source < 0 || source >= g.rows() || isVisited(source)) return reached;
+        markVisited(source);
+        hops[source] = 0;
+        reached.push_back(source);
+
+        size_t levelBegin = 0;  // The frontier is reached[levelBegin ..]
+        uint64_t frontierEdges = g.degree(source);
+        unexploredEdges -= frontierEdges;
+        bool bottomUp = false;
+        for (int level = 0; level < maxHops && levelBegin < reached.size(); ++level) {
+            if (stopRow >= 0 && hops[stopRow] != -1) break;
+            span<const int> frontier(reached.data() + levelBegin, reached.size() - levelBegin);
+            if (!bottomUp && frontierEdges > unexploredEdges / alpha) bottomUp = true;
+            else if (bottomUp && frontier.size() < size_t(g.rows()) / beta) bottomUp = false;
+
+            if (bottomUp) stepBottomUp(frontier, level);
+            else stepTopDown(frontier, level);
+
+            levelBegin = reached.size();
+            frontierEdges = 0;
+            for (auto& list : local) {
+                for (int v : list) frontierEdges += g.degree(v);
+                reached.insert(reached.end(), list.begin(), list.end());
+                list.clear();
+            }
+            unexploredEdges -= frontierEdges;
+        }
+        touched.insert(touched.end(), reached.begin(), reached.end());
+        return reached;
     }
+
+private:
+    static constexpr uint64_t alpha = 14;  // Switching thresholds from Beamer et al.
+    static constexpr size_t beta = 24;
+
+    CsrView g;
+    unsigned workers;
+    vector<atomic<uint64_t>> visited, frontierBits;  // One bit per row
+    vector<vector<int>> local;                       // Next-frontier rows found by each worker
+    vector<int> reached;
+    vector<int> touched;  // Rows reached by every run since the last reset() or clear()
+    uint64_t unexploredEdges = 0;
+
+    size_t words() const { return (g.rows() + 63) / 64; }
+    bool isVisited(int row) const { return visited[row >> 6].load(memory_order_relaxed) >> (row & 63) & 1; }
+    void markVisited(int row) { visited[row >> 6].fetch_or(1ULL << (row & 63), memory_order_relaxed); }
+
+    void stepTopDown(span<const int> frontier, int level) {
+        parallelChunks(frontier.size(), workers, [&](unsigned id, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                int u = frontier[i];
+                for (uint64_t k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.neighbors[k];
+                    uint64_t bit = 1ULL << (v & 63);
+                    if (visited[v >> 6].load(memory_order_relaxed) & bit) continue;
+                    if (visited[v >> 6].fetch_or(bit, memory_order_relaxed) & bit) continue;  // Another worker won v
+                    hops[v] = level + 1;
+                    local[id].push_back(v);
+                }
+            }
+        });
+    }
+
+    void stepBottomUp(span<const int> frontier, int level) {
+        for (int u : frontier) frontierBits[u >> 6].fetch_or(1ULL << (u & 63), memory_order_relaxed);
+        parallelChunks(g.rows(), workers, [&](unsigned id, size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                if (isVisited(v)) continue;
+                for (uint64_t k = g.offsets[v]; k < g.offsets[v + 1]; ++k) {
+                    int u = g.neighbors[k];
+                    if (!(frontierBits[u >> 6].load(memory_order_relaxed) >> (u & 63) & 1)) continue;
+                    markVisited(v);
+                    hops[v] = level + 1;
+                    local[id].push_back(v);
+                    break;  // One parent in the frontier is enough
+                }
+            }
+        });
+        for (int u : frontier) frontierBits[u >> 6].store(0, memory_order_relaxed);
+    }
+};
+
+// On-disk graph format (version 2), little-endian, every section 8-byte aligned:
+//   header | ids: int32[rows] | offsets: uint64[rows + 1] | neighbors: int32[edges] | weights: float64[edges]
+//   | byId: int32[rows]
+// The weights section is present only when flags has GraphFileHeader::hasWeights, and
+// byId only when flags has GraphFileHeader::hasRowIndex (rows relabeled, ids unsorted).
+// Version 1 files have neither byIdAt nor byId and are still accepted.
+// Readers mmap the file and use the sections in place, so startup does no parsing
+// and every process serving the same file shares one copy in the page cache.
+struct GraphFileHeader {
+    static constexpr char expectedMagic[8] = {'S', 'P', 'G', 'R', 'A', 'P', 'H', 0};
+    static constexpr uint32_t currentVersion = 2;
+    static constexpr uint32_t hasWeights = 1;
+    static constexpr uint32_t hasRowIndex = 2;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t rows;
+    uint64_t edges;
+    uint64_t idsAt, offsetsAt, neighborsAt, weightsAt;  // Byte offsets from the start of the file
+    uint64_t byIdAt;                                     // Since version 2
+};
+
+inline uint64_t alignTo8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+// Whether the arrays of a mapped graph file can be queried safely: offsets start at
+// 0, never decrease and end at the edge count, and every neighbor and byId entry is
+// a row. This reads the whole file, O(rows + edges), so opening runs it only on request.
+inline bool consistentCsr(const uint64_t* offsets, const int* neighbors, int rows, uint64_t edges, const int* byId) {
+    if (offsets[0] != 0 || offsets[rows] != edges) return false;
+    for (int r = 0; r < rows; ++r) {
+        if (offsets[r] > offsets[r + 1]) return false;
+    }
+    auto isRow = [&](int r) { return r >= 0 && r < rows; };
+    return all_of(neighbors, neighbors + edges, isRow) && (!byId || all_of(byId, byId + rows, isRow));
+}
+
+// Write a CSR graph (and optional per-edge weights) in the on-disk format
+bool writeGraphFile(const string& path, CsrView graph, const double* weights = nullptr) {
+    if constexpr (endian::native != endian::little) return false;  // The format is little-endian only
+    GraphFileHeader header = {};
+    memcpy(header.magic, GraphFileHeader::expectedMagic, sizeof(header.magic));
+    header.version = GraphFileHeader::currentVersion;
+    header.flags = (weights ? GraphFileHeader::hasWeights : 0) | (graph.byId ? GraphFileHeader::hasRowIndex : 0);
+    header.rows = graph.rows();
+    header.edges = graph.edges();
+    header.idsAt = alignTo8(sizeof(header));
+    header.offsetsAt = alignTo8(header.idsAt + header.rows * sizeof(int));
+    header.neighborsAt = header.offsetsAt + (header.rows + 1) * sizeof(uint64_t);
+    uint64_t end = alignTo8(header.neighborsAt + header.edges * sizeof(int));
+    header.weightsAt = weights ? end : 0;
+    if (weights) end = header.weightsAt + header.edges * sizeof(double);
+    header.byIdAt = graph.byId ? end : 0;
+
+    ofstream out(path, ios::binary);
+    auto section = [&](uint64_t at, const void* bytes, uint64_t size) {
+        static const char zeros[8] = {};
+        out.write(zeros, at - uint64_t(out.tellp()));  // Padding up to the section
+        out.write(static_cast<const char*>(bytes), size);
+    };
+    const uint64_t emptyOffsets[1] = {0};
+    section(0, &header, sizeof(header));
+    section(header.idsAt, graph.ids, header.rows * sizeof(int));
+    section(header.offsetsAt, graph.rows() ? graph.offsets : emptyOffsets, (header.rows + 1) * sizeof(uint64_t));
+    section(header.neighborsAt, graph.neighbors, header.edges * sizeof(int));
+    if (weights) section(header.weightsAt, weights, header.edges * sizeof(double));
+    if (graph.byId) section(header.byIdAt, graph.byId, header.rows * sizeof(int));
+    return bool(out);
+}
+
+// A graph file mapped read-only into memory and queried in place
+class MappedGraph {
+public:
+    MappedGraph() = default;
+    MappedGraph(const MappedGraph&) = delete;
+    MappedGraph& operator=(const MappedGraph&) = delete;
+    ~MappedGraph() { close(); }
+
+    // Map a graph file. The header and section bounds are always checked, in O(1).
+    // With verify, every offset, neighbor and byId entry is checked as well: a
+    // corrupt file then cannot open, but the whole file is read once, O(rows + edges),
+    // instead of being paged in lazily. Use it for files from untrusted sources.
+    bool open(const string& path, bool verify = false) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && uint64_t(info.st_size) >= sizeof(GraphFileHeader)) {
+            length = info.st_size;
+            base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);  // The mapping stays valid after the descriptor is closed
+        if (base == MAP_FAILED || !validate(verify)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base != MAP_FAILED) munmap(base, length);
+        base = MAP_FAILED;
+        length = 0;
+        graph = CsrView();
+        weights = nullptr;
+    }
+
+    CsrView view() const { return graph; }
+    const double* edgeWeights() const { return weights; }  // nullptr if the file has none
+
+    bool isConnected(int user1, int user2) const {
+        int row1 = graph.rowOf(user1), row2 = graph.rowOf(user2);
+        return row1 != -1 && row2 != -1 && graph.rowContains(row1, row2);
+    }
+
+private:
+    void* base = MAP_FAILED;
+    size_t length = 0;
+    CsrView graph;
+    const double* weights = nullptr;
+
+    // Check the header and that every section lies inside the file, and with verify
+    // that the arrays are consistent (queries index them directly)
+    bool validate(bool verify) {
+        if constexpr (endian::native != endian::little) return false;
+        const char* bytes = static_cast<const char*>(base);
+        const auto* header = reinterpret_cast<const GraphFileHeader*>(bytes);
+        if (memcmp(header->magic, GraphFileHeader::expectedMagic, sizeof(header->magic)) != 0) return false;
+        if (header->version < 1 || header->version > GraphFileHeader::currentVersion) return false;
+        if (header->rows > uint64_t(INT_MAX)) return false;
+        auto fits = [&](uint64_t at, uint64_t count, uint64_t size) {
+            return at % 8 == 0 && at <= length && count <= (length - at) / size;
+        };
+        bool weighted = header->flags & GraphFileHeader::hasWeights;
+        bool indexed = header->version >= 2 && (header->flags & GraphFileHeader::hasRowIndex);
+        if (!fits(header->idsAt, header->rows, sizeof(int)) ||
+            !fits(header->offsetsAt, header->rows + 1, sizeof(uint64_t)) ||
+            !fits(header->neighborsAt, header->edges, sizeof(int)) ||
+            (weighted && !fits(header->weightsAt, header->edges, sizeof(double))) ||
+            (indexed && !fits(header->byIdAt, header->rows, sizeof(int))))
+            return false;
+        graph.ids = reinterpret_cast<const int*>(bytes + header->idsAt);
+        graph.offsets = reinterpret_cast<const uint64_t*>(bytes + header->offsetsAt);
+        graph.neighbors = reinterpret_cast<const int*>(bytes + header->neighborsAt);
+        graph.rowCount = header->rows;
+        graph.byId = indexed ? reinterpret_cast<const int*>(bytes + header->byIdAt) : nullptr;
+        if (graph.offsets[graph.rowCount] != header->edges) return false;
+        if (verify && !consistentCsr(graph.offsets, graph.neighbors, graph.rowCount, header->edges, graph.byId))
+            return false;
+        weights = weighted ? reinterpret_cast<const double*>(bytes + header->weightsAt) : nullptr;
+        return true;
+    }
+};
+
+// Sorted-set intersection kernels. Each writes the common elements of two sorted,
+// duplicate-free arrays to `out` (if not nullptr) and returns how many there are.
+size_t intersectScalar(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, count = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (a[i] > b[j]) {
+            ++j;
+        } else {
+            if (out) out[count] = a[i];
+            ++count, ++i, ++j;
+        }
+    }
+    return count;
+}
+
+#ifdef HAVE_X86_SIMD
+// Block-wise merge: compare a block of a against every rotation of a block of b,
+// so all pairs are checked with a few compares, then advance the block whose last
+// element is smaller. Leftovers are finished by the scalar merge.
+__attribute__((target("sse4.2")))
+size_t intersectSse(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, count = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                                                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+                                   _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4E)),
+                                                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(hit));
+        if (out) {
+            for (unsigned m = mask; m; m &= m - 1) out[count++] = a[i + __builtin_ctz(m)];
+        } else {
+            count += __builtin_popcount(mask);
+        }
+        int lastA = a[i + 3], lastB = b[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+    return count + intersectScalar(a + i, na - i, b + j, nb - j, out ? out + count : nullptr);
+}
+
+__attribute__((target("avx2")))
+size_t intersectAvx2(const int* a, size_t na, const int* b, size_t nb, int* out) {
+    size_t i = 0, j = 0, count = 0;
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i hit = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; ++r) {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(va, vb));
+        }
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+        if (out) {
+            for (unsigned m = mask; m; m &= m - 1) out[count++] = a[i + __builtin_ctz(m)];
+        } else {
+            count += __builtin_popcount(mask);
+        }
+        int lastA = a[i + 7], lastB = b[j + 7];
+        if (lastA <= lastB) i += 8;
+        if (lastB <= lastA) j += 8;
+    }
+    return count + intersectSse(a + i, na - i, b + j, nb - j, out ? out + count : nullptr);
+}
+#endif
+
+// Pick the widest kernel the CPU supports, once per process
+size_t intersectSorted(const int* a, size_t na, const int* b, size_t nb, int* out = nullptr) {
+    using Kernel = size_t (*)(const int*, size_t, const int*, size_t, int*);
+    static const Kernel kernel = [] {
+#ifdef HAVE_X86_SIMD
+        if (__builtin_cpu_supports("avx2")) return Kernel(intersectAvx2);
+        if (__builtin_cpu_supports("sse4.2")) return Kernel(intersectSse);
+#endif
+        return Kernel(intersectScalar);
+    }();
+    return kernel(a, na, b, nb, out);
+}
+
+// Split the rows of a graph into `parts` contiguous blocks with roughly equal
+// edge counts; block p is rows [bounds[p], bounds[p + 1])
+vector<int> balancedRowBlocks(CsrView g, unsigned parts) {
+    vector<int> bounds(parts + 1, g.rows());
+    for (unsigned p = 0; p < parts; ++p) {
+        uint64_t target = g.edges() * p / parts;
+        bounds[p] = g.rows() ? lower_bound(g.offsets, g.offsets + g.rows(), target) - g.offsets : 0;
+    }
+    return bounds;
+}
+
+// Sparse matrix-vector multiply y = A x, where A is the 0/1 adjacency matrix of
+// the graph (x and y are indexed by row). Rows are split between workers by edge
+// count rather than row count, so a few very popular users do not leave the
+// other workers idle.
+template <typename T>
+void spmv(CsrView g, const T* x, T* y, unsigned threads = thread::hardware_concurrency()) {
+    unsigned workers = max<uint64_t>(1, min<uint64_t>(threads, g.edges() / 65536));
+    vector<int> bounds = balancedRowBlocks(g, workers);
+    runWorkers(workers, [&](unsigned id) {
+        for (int r = bounds[id]; r < bounds[id + 1]; ++r) {
+            T sum = 0;
+            for (uint64_t k = g.offsets[r]; k < g.offsets[r + 1]; ++k) sum += x[g.neighbors[k]];
+            y[r] = sum;
+        }
+    });
+}
+
+template <typename T>
+struct PageRankOptions {
+    T damping = T(0.85);
+    T tolerance = T(1e-6);  // Stop once the L1 change between iterations drops below this
+    int maxIterations = 100;
+    unsigned threads = thread::hardware_concurrency();
+};
+
+template <typename T>
+struct PageRankResult {
+    vector<T> rank;  // Indexed by row, sums to 1
+    int iterations = 0;
+    T change = 0;    // L1 change in the last iteration
 };
 
+// PageRank by power iteration on top of spmv(). `teleport` is the restart
+// distribution by row (empty = uniform); a non-uniform one gives personalized
+// PageRank. Rank held by users without friends is redistributed like a restart.
+template <typename T>
+PageRankResult<T> pageRank(CsrView g, const PageRankOptions<T>& options = {}, span<const T> teleport = {}) {
+    const int n = g.rows();
+    PageRankResult<T> result;
+    if (n == 0) return result;
+    vector<T> restart(n, T(1) / n);
+    if (!teleport.empty()) {
+        T total = accumulate(teleport.begin(), teleport.end(), T(0));
+        for (int r = 0; r < n; ++r) restart[r] = teleport[r] / total;
+    }
+
+    result.rank = restart;
+    vector<T> share(n), gathered(n);
+    while (result.iterations < options.maxIterations) {
+        T dangling = 0;
+        for (int r = 0; r < n; ++r) {
+            if (g.degree(r) == 0) dangling += result.rank[r];
+            share[r] = g.degree(r) ? result.rank[r] / T(g.degree(r)) : T(0);
+        }
+        spmv(g, share.data(), gathered.data(), max(options.threads, 1u));
+
+        result.change = 0;
+        for (int r = 0; r < n; ++r) {
+            T next = options.damping * (gathered[r] + dangling * restart[r]) + (1 - options.damping) * restart[r];
+            result.change += abs(next - result.rank[r]);
+            result.rank[r] = next;
+        }
+        ++result.iterations;
+        if (result.change < options.tolerance) break;
+    }
+    return result;
+}
+
+// Pack an ordered (user1, user2) pair into one key whose unsigned order matches
+// the signed order of (user1, user2), so sorting keys sorts the pairs
+inline uint64_t packEdge(int user1, int user2) {
+    return uint64_t(uint32_t(user1) ^ 0x80000000u) << 32 | (uint32_t(user2) ^ 0x80000000u);
+}
+inline int edgeSource(uint64_t key) { return int(uint32_t(key >> 32) ^ 0x80000000u); }
+inline int edgeTarget(uint64_t key) { return int(uint32_t(key) ^ 0x80000000u); }
+
+// Parallel LSD radix sort, one byte per pass. Each worker histograms and then
+// scatters its own contiguous slice, so the sort is stable; passes where every
+// key has the same byte (e.g. the high bytes of small ids) are skipped.
+void radixSort(vector<uint64_t>& keys, unsigned threads) {
+    const size_t n = keys.size();
+    const unsigned workers = max<size_t>(1, min<size_t>(threads, n / 65536));
+    vector<uint64_t> scratch(n);
+    vector<size_t> counts(workers * 256);
+    auto slice = [&](unsigned id) { return pair<size_t, size_t>(n * id / workers, n * (id + 1) / workers); };
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        fill(counts.begin(), counts.end(), 0);
+        runWorkers(workers, [&](unsigned id) {
+            auto [begin, end] = slice(id);
+            for (size_t i = begin; i < end; ++i) ++counts[id * 256 + (keys[i] >> shift & 255)];
+        });
+
+        // counts becomes the write position of each (digit, worker) bucket
+        size_t position = 0;
+        bool singleDigit = false;
+        for (int digit = 0; digit < 256; ++digit) {
+            size_t digitTotal = 0;
+            for (unsigned id = 0; id < workers; ++id) {
+                size_t count = counts[id * 256 + digit];
+                counts[id * 256 + digit] = position;
+                position += count;
+                digitTotal += count;
+            }
+            if (digitTotal == n) singleDigit = true;
+        }
+        if (singleDigit) continue;
+
+        runWorkers(workers, [&](unsigned id) {
+            auto [begin, end] = slice(id);
+            for (size_t i = begin; i < end; ++i) scratch[counts[id * 256 + (keys[i] >> shift & 255)]++] = keys[i];
+        });
+        keys.swap(scratch);
+    }
+}
+
+enum class EdgeFileFormat {
+    Text,    // One "user1 user2" pair per line; blank lines and lines starting with '#' are skipped
+    Binary,  // Consecutive little-endian int32 (user1, user2) pairs
+};
+
+// Stream an edge list file in 1 MiB chunks, calling edge(user1, user2) per pair
+template <typename Edge>
+bool readEdgeFile(const string& path, EdgeFileFormat format, Edge edge) {
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    vector<char> buffer(1 << 20);
+    size_t carried = 0;  // Bytes of an incomplete line or pair kept from the previous chunk
+    for (bool last = false; !last;) {
+        in.read(buffer.data() + carried, buffer.size() - carried);
+        size_t filled = carried + in.gcount();
+        // A file that ends exactly at a chunk boundary is only seen to end by the next,
+        // empty read, which must still finish the carried final line
+        last = !in;
+        if (filled == 0) break;
+
+        size_t used = 0;
+        if (format == EdgeFileFormat::Binary) {
+            for (; used + 8 <= filled; used += 8) {
+                int32_t pair[2];
+                memcpy(pair, buffer.data() + used, 8);
+                edge(pair[0], pair[1]);
+            }
+        } else {
+            while (used < filled) {
+                const char* line = buffer.data() + used;
+                const char* end = static_cast<const char*>(memchr(line, '\n', filled - used));
+                if (!end && !last) break;  // Finish this line with the next chunk
+                if (!end) end = buffer.data() + filled;
+                while (line < end && (*line == ' ' || *line == '\t')) ++line;
+                int user1, user2;
+                auto first = from_chars(line, end, user1);
+                if (first.ec == errc() && *line != '#') {
+                    const char* next = first.ptr;
+                    while (next < end && (*next == ' ' || *next == '\t' || *next == ',')) ++next;
+                    if (from_chars(next, end, user2).ec == errc()) edge(user1, user2);
+                }
+                used = end - buffer.data() + 1;
+            }
+            used = min(used, filled);
+        }
+        if (used == 0 && filled == buffer.size()) buffer.resize(buffer.size() * 2);  // A single huge line
+        carried = filled - used;
+        memmove(buffer.data(), buffer.data() + used, carried);
+    }
+    return true;
+}
+
+// Storage for the per-friendship values of a graph. Weighted graphs keep one
+// Value per snapshot entry and a map per delta row; unweighted graphs (void)
+// keep no values at all and use a set per delta row.
+struct NoValues {};
+template <typename Value> struct SparseStorage {
+    using DeltaRow = unordered_map<int, Value>;
+    using SnapshotValues = vector<Value>;
+};
+template <> struct SparseStorage<void> {
+    using DeltaRow = unordered_set<int>;
+    using SnapshotValues = NoValues;
+};
+
+// Represent sparse matrix using a map of maps.
+// Value is what a friendship stores: void for a plain friend graph, or e.g.
+// uint8_t / float for weighted friendships. With upperTriangleOnly the delta
+// keeps each friendship once, under the smaller user id, instead of twice.
+template <typename Value = void>
+class BasicSparseMatrix {
+    static constexpr bool weighted = !is_void_v<Value>;
+    using DeltaRow = typename SparseStorage<Value>::DeltaRow;
+    using CellValue = conditional_t<weighted, Value, bool>;
+
+public:
+    CsrSnapshot snapshot;  // Frozen, read-optimized part of the graph
+    [[no_unique_address]] typename SparseStorage<Value>::SnapshotValues values;  // Parallel to snapshot.neighbors
+    unordered_map<int, DeltaRow> data;  // Delta: edges added since the last freeze()
+    unordered_set<uint64_t> removed;    // Snapshot edges removed since the last freeze(), as edgeKey()
+
+    explicit BasicSparseMatrix(bool upperTriangleOnly = false) : upperTriangle(upperTriangleOnly) {}
+
+    void addConnection(int user1, int user2) requires(!weighted) { link(user1, user2, true); }
+    void addConnection(int user1, int user2, CellValue value) requires weighted { link(user1, user2, value); }
+
+    // Unfriend in both directions; returns false if the users were not connected
+    bool removeConnection(int user1, int user2) {
+        auto [a, b] = deltaKey(user1, user2);
+        bool erased = eraseFromDelta(a, b);
+        if (!upperTriangle) eraseFromDelta(b, a);  // Undirected graph
+        if (snapshotSlot(user1, user2) != -1) erased = removed.insert(edgeKey(user1, user2)).second || erased;
+        return erased;
+    }
+
+    // Read-only lookup: the stored value, or nullopt if the users are not connected.
+    // Uses find() only, so querying unknown users never inserts empty rows.
+    optional<CellValue> connection(int user1, int user2) const requires weighted {
+        if (int64_t at = liveSnapshotSlot(user1, user2); at != -1) return values[at];
+        if (auto cell = deltaFind(user1, user2)) return cell->second;
+        return nullopt;
+    }
+
+    bool isConnected(int user1, int user2) const {
+        return liveSnapshotSlot(user1, user2) != -1 || deltaFind(user1, user2);
+    }
+
+    // Batch lookup: queries are grouped by user1 and sorted by the row of user2 inside
+    // a group, so each row is located once and galloped through from a cursor that only
+    // moves forward (neighbor lists are sorted by row, not by user id)
+    vector<bool> areConnected(span<const pair<int, int>> queries) const {
+        vector<pair<int, int>> keys(queries.size());
+        vector<int> rows2(queries.size());
+        for (size_t i = 0; i < queries.size(); ++i) {
+            keys[i] = deltaKey(queries[i].first, queries[i].second);
+            rows2[i] = snapshot.rowOf(keys[i].second);
+        }
+        vector<uint32_t> order(queries.size());
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return pair(keys[a].first, rows2[a]) < pair(keys[b].first, rows2[b]);
+        });
+
+        CsrView view = snapshot.view();
+        vector<bool> result(queries.size(), false);
+        for (size_t i = 0; i < order.size();) {
+            int user1 = keys[order[i]].first;
+            int row1 = snapshot.rowOf(user1);
+            const int* cursor = (row1 == -1) ? nullptr : view.rowBegin(row1);
+            const int* last = (row1 == -1) ? nullptr : view.rowEnd(row1);
+            auto delta = data.find(user1);
+            for (; i < order.size() && keys[order[i]].first == user1; ++i) {
+                int user2 = keys[order[i]].second;
+                int row2 = rows2[order[i]];
+                bool found = false;
+                if (row1 != -1 && row2 != -1) {
+                    cursor = CsrView::gallop(cursor, last, row2);
+                    found = cursor != last && *cursor == row2 && !isRemoved(user1, user2);
+                }
+                if (!found && delta != data.end()) found = delta->second.count(user2) > 0;
+                result[order[i]] = found;
+            }
+        }
+        return result;
+    }
+
+    // Visit every friend of a user: the contiguous snapshot row first, then the delta.
+    // In upper-triangle mode, friends with smaller ids are found by scanning the delta.
+    template <typename Visit>
+    void forEachFriend(int user, Visit visit) const {
+        int row = snapshot.rowOf(user);
+        if (row != -1) {
+            for (uint64_t k = snapshot.offsets[row]; k < snapshot.offsets[row + 1]; ++k) {
+                int friendId = snapshot.ids[snapshot.neighbors[k]];
+                if (!isRemoved(user, friendId)) visit(friendId);
+            }
+        }
+        auto delta = data.find(user);
+        if (delta != data.end()) {
+            for (const auto& cell : delta->second) visit(friendOf(cell));
+        }
+        if (upperTriangle) {
+            for (const auto& [smaller, cells] : data) {
+                if (smaller < user && cells.count(user)) visit(smaller);
+            }
+        }
+    }
+
+    // Traversals below run on the frozen snapshot; call freeze() first to apply pending
+    // additions and removals.
+
+    // BFS engine of the calling thread, kept between queries and rebuilt only when the
+    // snapshot layout or worker count changes; clear() then undoes just the rows the
+    // previous query reached, so a 2-hop query does not pay O(rows) to start
+    BfsEngine& reusableBfs(unsigned threads) const {
+        thread_local unique_ptr<BfsEngine> engine;
+        if (engine && engine->serves(snapshot.view(), threads)) engine->clear();
+        else engine = make_unique<BfsEngine>(snapshot.view(), threads);
+        return *engine;
+    }
+
+    // Users reachable from `user` in at most k hops (the user itself excluded)
+    vector<int> friendsWithinHops(int user, int k, unsigned threads = thread::hardware_concurrency()) const {
+        vector<int> result;
+        int row = snapshot.rowOf(user);
+        if (row == -1) return result;
+        BfsEngine& bfs = reusableBfs(threads);
+        for (int r : bfs.run(row, k)) {
+            if (r != row) result.push_back(snapshot.ids[r]);
+        }
+        return result;
+    }
+
+    // Fewest hops between two users, or -1 if they are not connected
+    int hopDistance(int user1, int user2, unsigned threads = thread::hardware_concurrency()) const {
+        int row1 = snapshot.rowOf(user1), row2 = snapshot.rowOf(user2);
+        if (row1 == -1 || row2 == -1) return -1;
+        BfsEngine& bfs = reusableBfs(threads);
+        bfs.run(row1, INT_MAX, row2);
+        return bfs.hops[row2];
+    }
+
+    // Component label of every snapshot row (indexed like snapshot.ids)
+    vector<int> connectedComponents(unsigned threads = thread::hardware_concurrency()) const {
+        vector<int> component(snapshot.rows(), -1);
+        BfsEngine bfs(snapshot.view(), threads);
+        int count = 0;
+        for (int r = 0; r < snapshot.rows(); ++r) {
+            if (component[r] != -1) continue;
+            for (int v : bfs.run(r)) component[v] = count;
+            ++count;
+        }
+        return component;
+    }
+
+    // Friends two users have in common
+    vector<int> mutualFriends(int user1, int user2) const {
+        vector<int> result;
+        int row1 = snapshot.rowOf(user1), row2 = snapshot.rowOf(user2);
+        if (row1 == -1 || row2 == -1) return result;
+        result.resize(min(snapshot.degree(row1), snapshot.degree(row2)));
+        result.resize(intersectSorted(rowBegin(row1), snapshot.degree(row1), rowBegin(row2), snapshot.degree(row2),
+                                      result.data()));
+        for (int& row : result) row = snapshot.ids[row];
+        return result;
+    }
+
+    size_t commonNeighborCount(int user1, int user2) const {
+        int row1 = snapshot.rowOf(user1), row2 = snapshot.rowOf(user2);
+        if (row1 == -1 || row2 == -1) return 0;
+        return intersectSorted(rowBegin(row1), snapshot.degree(row1), rowBegin(row2), snapshot.degree(row2));
+    }
+
+    // Number of triangles (three users who are all friends with each other).
+    // Each triangle u < v < w is counted once, by intersecting the parts of the
+    // rows of u and v that lie above v.
+    uint64_t triangleCount(unsigned threads = thread::hardware_concurrency()) const {
+        vector<uint64_t> perWorker(max(threads, 1u), 0);
+        parallelChunks(snapshot.rows(), max(threads, 1u), [&](unsigned id, size_t begin, size_t end) {
+            uint64_t count = 0;
+            for (size_t u = begin; u < end; ++u) {
+                const int* last = rowBegin(u) + snapshot.degree(u);
+                for (const int* v = upper_bound(rowBegin(u), last, int(u)); v < last; ++v) {
+                    const int* higherU = v + 1;
+                    const int* higherV = upper_bound(rowBegin(*v), rowBegin(*v) + snapshot.degree(*v), *v);
+                    count += intersectSorted(higherU, last - higherU, higherV, rowBegin(*v) + snapshot.degree(*v) - higherV);
+                }
+            }
+            perWorker[id] += count;
+        });
+        return accumulate(perWorker.begin(), perWorker.end(), uint64_t(0));
+    }
+
+    // Influence score of every snapshot row (indexed like snapshot.ids)
+    template <typename T = double>
+    PageRankResult<T> influence(const PageRankOptions<T>& options = {}) const {
+        return pageRank<T>(snapshot.view(), options);
+    }
+
+    // Personalized PageRank: random walks restart at the given users
+    template <typename T = double>
+    PageRankResult<T> personalizedInfluence(span<const int> seedUsers, const PageRankOptions<T>& options = {}) const {
+        vector<T> teleport(snapshot.rows(), T(0));
+        for (int user : seedUsers) {
+            int row = snapshot.rowOf(user);
+            if (row != -1) teleport[row] = 1;
+        }
+        if (find(teleport.begin(), teleport.end(), T(1)) == teleport.end()) return {};
+        return pageRank<T>(snapshot.view(), options, teleport);
+    }
+
+    // Bulk loader: builds the CSR snapshot straight from an edge list file instead of
+    // calling addConnection() per edge. Both directions of every edge are packed into
+    // 64-bit keys, radix sorted in parallel, deduplicated and emitted as CSR in one pass.
+    // Peak memory is about 32 bytes per input edge (two keys plus the radix sort's
+    // scratch buffer) plus 12 bytes per user for binary files, whose key vector is
+    // reserved from the file size. Text files give no edge count up front, so the
+    // vector grows by doubling and may peak at about 48 bytes per edge (old and new
+    // buffers during a reallocation, or spare capacity next to the scratch buffer).
+    // The file itself is streamed in chunks.
+    // Returns nullopt if the file cannot be read.
+    static optional<BasicSparseMatrix> fromEdgeList(const string& path, EdgeFileFormat format = EdgeFileFormat::Text,
+                                                    unsigned threads = thread::hardware_concurrency())
+        requires(!weighted) {
+        vector<uint64_t> keys;
+        struct stat info;
+        if (format == EdgeFileFormat::Binary && stat(path.c_str(), &info) == 0) keys.reserve(info.st_size / 8 * 2);
+        bool ok = readEdgeFile(path, format, [&](int user1, int user2) {
+            keys.push_back(packEdge(user1, user2));
+            if (user1 != user2) keys.push_back(packEdge(user2, user1));  // Undirected graph
+        });
+        if (!ok) return nullopt;
+        radixSort(keys, max(threads, 1u));
+        keys.erase(unique(keys.begin(), keys.end()), keys.end());
+
+        BasicSparseMatrix matrix;
+        CsrSnapshot& g = matrix.snapshot;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (i == 0 || edgeSource(keys[i]) != edgeSource(keys[i - 1])) {
+                g.ids.push_back(edgeSource(keys[i]));
+                g.offsets.push_back(i);
+            }
+        }
+        g.offsets.push_back(keys.size());
+        g.neighbors.resize(keys.size());
+        parallelChunks(keys.size(), max(threads, 1u), [&](unsigned, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) g.neighbors[i] = g.rowOf(edgeTarget(keys[i]));
+        });
+        return matrix;
+    }
+
+    // Write the frozen snapshot (not the delta) in the mmap-able graph file format.
+    // Numeric friendship values go to the weights section as float64.
+    bool saveSnapshot(const string& path) const {
+        if constexpr (weighted && is_arithmetic_v<Value>) {
+            vector<double> weights(values.begin(), values.end());
+            return writeGraphFile(path, snapshot.view(), weights.data());
+        } else {
+            return writeGraphFile(path, snapshot.view());
+        }
+    }
+
+    // Merge the delta into a new CSR snapshot, drop removed edges, and clear the delta.
+    // A relabeled snapshot keeps its row order, and new users are appended at the end.
+    void freeze() {
+        // Every delta friendship in both directions (user ids now, snapshot rows later)
+        struct Entry {
+            int row, friendRow;
+            CellValue value;
+        };
+        vector<Entry> entries;
+        vector<int> added;  // Users not in the snapshot yet
+        for (const auto& [user, cells] : data) {
+            for (const auto& cell : cells) {
+                entries.push_back({user, friendOf(cell), valueOf(cell)});
+                if (upperTriangle && friendOf(cell) != user) entries.push_back({friendOf(cell), user, valueOf(cell)});
+            }
+        }
+        for (const Entry& e : entries) {
+            if (snapshot.rowOf(e.row) == -1) added.push_back(e.row);
+        }
+        sort(added.begin(), added.end());
+        added.erase(unique(added.begin(), added.end()), added.end());
+
+        CsrSnapshot next;
+        next.ids = snapshot.ids;
+        next.ids.insert(next.ids.end(), added.begin(), added.end());
+        if (snapshot.byId.empty()) inplace_merge(next.ids.begin(), next.ids.begin() + snapshot.rows(), next.ids.end());
+        next.indexIds();
+
+        vector<int> oldToNew(snapshot.rows());
+        for (int r = 0; r < snapshot.rows(); ++r) oldToNew[r] = next.rowOf(snapshot.ids[r]);
+        for (Entry& e : entries) e.row = next.rowOf(e.row), e.friendRow = next.rowOf(e.friendRow);
+        sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.row < b.row; });
+
+        typename SparseStorage<Value>::SnapshotValues nextValues;
+        next.offsets.reserve(next.rows() + 1);
+        next.offsets.push_back(0);
+        next.neighbors.reserve(snapshot.edges());
+        vector<pair<int, CellValue>> row;
+        size_t e = 0;
+        for (int r = 0; r < next.rows(); ++r) {
+            row.clear();
+            if (int old = snapshot.rowOf(next.ids[r]); old != -1) {
+                for (uint64_t k = snapshot.offsets[old]; k < snapshot.offsets[old + 1]; ++k) {
+                    if (isRemoved(next.ids[r], snapshot.ids[snapshot.neighbors[k]])) continue;
+                    if constexpr (weighted) row.push_back({oldToNew[snapshot.neighbors[k]], values[k]});
+                    else row.push_back({oldToNew[snapshot.neighbors[k]], true});
+                }
+            }
+            for (; e < entries.size() && entries[e].row == r; ++e) row.push_back({entries[e].friendRow, entries[e].value});
+            sort(row.begin(), row.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (const auto& [friendRow, value] : row) {
+                next.neighbors.push_back(friendRow);
+                if constexpr (weighted) nextValues.push_back(value);
+            }
+            next.offsets.push_back(next.neighbors.size());
+        }
+
+        next.neighbors.shrink_to_fit();
+        snapshot = move(next);
+        values = move(nextValues);
+        data.clear();
+        removed.clear();
+    }
+
+    // Relabel the snapshot rows for cache locality (pending changes are frozen first).
+    // User ids do not change; snapshot.ids keeps translating rows back to users, so
+    // row-indexed results such as influence() scores follow the new order.
+    void reorder(RowOrder order) {
+        freeze();
+        vector<uint64_t> sourceEntry;
+        snapshot = permuteRows(snapshot.view(), localityOrder(snapshot.view(), order), &sourceEntry);
+        if constexpr (weighted) {
+            typename SparseStorage<Value>::SnapshotValues moved(sourceEntry.size());
+            for (size_t k = 0; k < sourceEntry.size(); ++k) moved[k] = values[sourceEntry[k]];
+            values = move(moved);
+        }
+    }
+
+private:
+    bool upperTriangle;
+
+    const int* rowBegin(int row) const { return snapshot.neighbors.data() + snapshot.offsets[row]; }
+
+    static int friendOf(int cell) { return cell; }
+    static int friendOf(const pair<const int, CellValue>& cell) { return cell.first; }
+    static CellValue valueOf(int) { return true; }
+    static CellValue valueOf(const pair<const int, CellValue>& cell) { return cell.second; }
+
+    // Key of an undirected edge, the same for both directions
+    static uint64_t edgeKey(int user1, int user2) {
+        return user1 < user2 ? packEdge(user1, user2) : packEdge(user2, user1);
+    }
+
+    // Where an edge lives in the delta: (smaller, larger) in upper-triangle mode
+    pair<int, int> deltaKey(int user1, int user2) const {
+        if (upperTriangle && user1 > user2) swap(user1, user2);
+        return {user1, user2};
+    }
+
+    const typename DeltaRow::value_type* deltaFind(int user1, int user2) const {
+        auto [a, b] = deltaKey(user1, user2);
+        auto row = data.find(a);
+        if (row == data.end()) return nullptr;
+        auto cell = row->second.find(b);
+        return cell == row->second.end() ? nullptr : &*cell;
+    }
+
+    bool eraseFromDelta(int a, int b) {
+        auto row = data.find(a);
+        if (row == data.end()) return false;
+        bool erased = row->second.erase(b) > 0;
+        if (row->second.empty()) data.erase(row);  // Keep the delta free of empty rows
+        return erased;
+    }
+
+    bool isRemoved(int user1, int user2) const {
+        return !removed.empty() && removed.count(edgeKey(user1, user2));
+    }
+
+    // Index of the snapshot entry user1 -> user2 (even if removed since), or -1
+    int64_t snapshotSlot(int user1, int user2) const {
+        int row1 = snapshot.rowOf(user1);
+        if (row1 == -1) return -1;
+        int row2 = snapshot.rowOf(user2);
+        const int* at = (row2 == -1) ? nullptr : snapshot.view().findInRow(row1, row2);
+        return at ? at - snapshot.neighbors.data() : -1;
+    }
+
+    int64_t liveSnapshotSlot(int user1, int user2) const {
+        int64_t at = snapshotSlot(user1, user2);
+        return (at != -1 && isRemoved(user1, user2)) ? -1 : at;
+    }
+
+    void link(int user1, int user2, const CellValue& value) {
+        if (int64_t at = snapshotSlot(user1, user2); at != -1) {
+            removed.erase(edgeKey(user1, user2));  // Already frozen: revive it, update the value in place
+            if constexpr (weighted) {
+                values[at] = value;
+                values[snapshotSlot(user2, user1)] = value;
+            }
+            return;
+        }
+        auto [a, b] = deltaKey(user1, user2);
+        if constexpr (weighted) {
+            data[a].insert_or_assign(b, value);
+            if (!upperTriangle) data[b].insert_or_assign(a, value);  // Undirected graph
+        } else {
+            data[a].insert(b);
+            if (!upperTriangle) data[b].insert(a);  // Undirected graph
+        }
+    }
+};
+
+using SparseMatrix = BasicSparseMatrix<>;  // Unweighted friend graph
+
+// Epoch-based reclamation shared by all concurrent structures. A reader pins
+// the current epoch in its own slot while it looks at shared blocks; a block
+// that was unpublished during epoch R is freed only once every pinned slot is
+// past R, i.e. once no reader can still hold a pointer to it.
+class EpochDomain {
+    struct alignas(64) Slot {  // One cache line each, so readers do not share lines
+        atomic<uint64_t> epoch{0};  // 0 = not pinned
+        atomic<bool> taken{false};
+        int depth = 0;  // Live Guards of the owning thread; only that thread touches it
+    };
+
+public:
+    static EpochDomain& instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    // Pins the calling thread's epoch for the Guard's lifetime: two atomic stores,
+    // never waits. Guards may nest; the thread has one slot, so only the outermost
+    // Guard pins and unpins it, and inner ones keep the outer (older) epoch.
+    class Guard {
+    public:
+        Guard() : slot(EpochDomain::instance().threadSlot()) {
+            if (slot.depth++ == 0) slot.epoch.store(EpochDomain::instance().global.load());
+        }
+        ~Guard() {
+            if (--slot.depth == 0) slot.epoch.store(0, memory_order_release);
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        Slot& slot;
+    };
+
+    uint64_t current() const { return global.load(); }
+    void advance() { global.fetch_add(1); }
+
+    // Oldest epoch still pinned by a reader, or UINT64_MAX if none is
+    uint64_t oldestPinned() const {
+        uint64_t oldest = UINT64_MAX;
+        for (const Slot& s : slots) {
+            uint64_t e = s.epoch.load();
+            if (e != 0) oldest = min(oldest, e);
+        }
+        return oldest;
+    }
+
+private:
+    static constexpr int maxThreads = 256;
+
+    Slot slots[maxThreads];
+    atomic<uint64_t> global{1};
+
+    // Each thread claims a slot on first use and hands it back when it exits
+    Slot& threadSlot() {
+        struct Owner {
+            Slot* slot = nullptr;
+            ~Owner() {
+                if (slot) slot->taken.store(false);
+            }
+        };
+        thread_local Owner owner;
+        if (!owner.slot) {
+            for (Slot& s : slots) {
+                bool expected = false;
+                if (s.taken.compare_exchange_strong(expected, true)) {
+                    owner.slot = &s;
+                    break;
+                }
+            }
+            if (!owner.slot) throw runtime_error("EpochDomain: too many reader threads");
+        }
+        return *owner.slot;
+    }
+};
+
+// Friend graph for many reader threads and writers applying friend/unfriend
+// events. Every row is an immutable sorted block; a writer copies the row,
+// changes the copy and publishes it with one atomic pointer store, so reads are
+// wait-free and never block on writers. Writers serialize on a mutex that
+// readers never touch. The two rows of an edge are published one after the
+// other, so a reader may briefly see the edge from one side only.
+// User ids are dense in [0, capacity).
+class ConcurrentSparseMatrix {
+public:
+    explicit ConcurrentSparseMatrix(int capacity) : capacity(capacity), rows(new atomic<const Row*>[capacity]) {
+        for (int u = 0; u < capacity; ++u) rows[u].store(nullptr, memory_order_relaxed);
+    }
+
+    ~ConcurrentSparseMatrix() {  // No reader may still be running
+        for (int u = 0; u < capacity; ++u) freeRow(rows[u].load());
+        for (const auto& [epoch, row] : retired) freeRow(row);
+    }
+
+    bool isConnected(int user1, int user2) const {
+        if (!valid(user1)) return false;
+        EpochDomain::Guard guard;
+        const Row* row = pinnedRow(user1);
+        return row && binary_search(row->friends(), row->friends() + row->size, user2);
+    }
+
+    // Copy of a user's friend list as of one published version of the row
+    vector<int> friendsOf(int user) const {
+        if (!valid(user)) return {};
+        EpochDomain::Guard guard;
+        const Row* row = pinnedRow(user);
+        return row ? vector<int>(row->friends(), row->friends() + row->size) : vector<int>();
+    }
+
+    // Returns false if an id is out of range
+    bool addConnection(int user1, int user2) {
+        if (!valid(user1) || !valid(user2)) return false;
+        lock_guard<mutex> lock(writeLock);
+        publish(user1, user2, true);
+        if (user1 != user2) publish(user2, user1, true);  // Undirected graph
+        reclaim();
+        return true;
+    }
+
+    bool removeConnection(int user1, int user2) {
+        if (!valid(user1) || !valid(user2)) return false;
+        lock_guard<mutex> lock(writeLock);
+        publish(user1, user2, false);
+        if (user1 != user2) publish(user2, user1, false);
+        reclaim();
+        return true;
+    }
+
+private:
+    struct Row {
+        uint32_t size;
+        const int* friends() const { return reinterpret_cast<const int*>(this + 1); }
+        int* friends() { return reinterpret_cast<int*>(this + 1); }
+    };
+
+    const int capacity;
+    unique_ptr<atomic<const Row*>[]> rows;
+    mutex writeLock;
+    vector<pair<uint64_t, const Row*>> retired;  // (epoch it was unpublished in, row)
+
+    bool valid(int user) const { return user >= 0 && user < capacity; }
+
+    // Row load for a reader holding a Guard. It must be seq_cst: with acquire the
+    // load may be ordered before the Guard's pin store, so reclaim() could scan the
+    // slots, miss the pin and free the very row this reader is about to use.
+    const Row* pinnedRow(int user) const { return rows[user].load(memory_order_seq_cst); }
+
+    static Row* allocateRow(uint32_t size) {
+        Row* row = static_cast<Row*>(::operator new(sizeof(Row) + size * sizeof(int)));
+        row->size = size;
+        return row;
+    }
+    static void freeRow(const Row* row) { ::operator delete(const_cast<Row*>(row)); }
+
+    // Publish a copy of user's row with `other` inserted or erased
+    void publish(int user, int other, bool insert) {
+        const Row* old = rows[user].load(memory_order_relaxed);
+        const int* first = old ? old->friends() : nullptr;
+        uint32_t size = old ? old->size : 0;
+        const int* at = lower_bound(first, first + size, other);
+        bool present = at != first + size && *at == other;
+        if (present == insert) return;  // Nothing to change
+
+        size_t before = at - first;
+        Row* next = allocateRow(insert ? size + 1 : size - 1);
+        copy(first, at, next->friends());
+        if (insert) {
+            next->friends()[before] = other;
+            copy(at, first + size, next->friends() + before + 1);
+        } else {
+            copy(at + 1, first + size, next->friends() + before);
+        }
+        rows[user].store(next, memory_order_seq_cst);
+        if (old) retired.push_back({EpochDomain::instance().current(), old});
+    }
+
+    // Free retired rows that no pinned reader can still see
+    void reclaim() {
+        EpochDomain& domain = EpochDomain::instance();
+        domain.advance();
+        uint64_t oldest = domain.oldestPinned();
+        auto freed = [&](const pair<uint64_t, const Row*>& r) {
+            if (r.first >= oldest) return false;  // A reader may still hold it
+            freeRow(r.second);
+            return true;
+        };
+        retired.erase(remove_if(retired.begin(), retired.end(), freed), retired.end());
+    }
+};
+
+// Lookups per second with `readers` threads querying while one writer churns edges
+double readerThroughput(ConcurrentSparseMatrix& graph, int users, int readers, chrono::milliseconds duration) {
+    atomic<bool> stop{false};
+    atomic<uint64_t> lookups{0};
+    vector<thread> pool;
+    for (int id = 0; id < readers; ++id) {
+        pool.emplace_back([&, id] {
+            uint64_t done = 0;
+            for (uint32_t x = id * 7919 + 1; !stop.load(memory_order_relaxed); ++done) {
+                x = x * 1664525 + 1013904223;  // Cheap pseudo-random user pairs
+                graph.isConnected(x % users, (x >> 16) % users);
+            }
+            lookups += done;
+        });
+    }
+    thread writer([&] {
+        for (uint32_t x = 12345; !stop.load(memory_order_relaxed);) {
+            x = x * 1664525 + 1013904223;
+            if (x & 1) graph.addConnection(x % users, (x >> 16) % users);
+            else graph.removeConnection(x % users, (x >> 16) % users);
+        }
+    });
+    this_thread::sleep_for(duration);
+    stop = true;
+    for (auto& t : pool) t.join();
+    writer.join();
+    return lookups * 1000.0 / duration.count();
+}
+
+// Cache behaviour of one BFS and a few SpMV passes over a frozen graph, single-threaded
+// so that only the memory layout differs between runs
+void localityBenchmark(const SparseMatrix& graph, const char* label) {
+    CsrView g = graph.snapshot.view();
+    uint64_t gap = 0;  // Mean distance between a row and its friends' rows in the arrays
+    for (int r = 0; r < g.rows(); ++r) {
+        for (uint64_t k = g.offsets[r]; k < g.offsets[r + 1]; ++k) gap += abs(g.neighbors[k] - r);
+    }
+    CacheMissCounter misses;
+    auto measure = [&](auto work) {
+        auto begin = chrono::steady_clock::now();
+        misses.start();
+        work();
+        uint64_t count = misses.stop();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        cout << ms << " ms";
+        if (misses.valid()) cout << ", " << count << " cache misses";
+    };
+    cout << label << ": mean friend-row gap " << gap / max<uint64_t>(g.edges(), 1) << "; BFS ";
+    BfsEngine bfs(g, 1);
+    measure([&] { bfs.run(0); });
+    cout << "; 10 SpMV ";
+    vector<float> x(g.rows(), 1), y(g.rows());
+    measure([&] {
+        for (int i = 0; i < 10; ++i) spmv(g, x.data(), y.data(), 1), swap(x, y);
+    });
+    cout << endl;
+}
+
 int main() {
     SparseMatrix network;
     network.addConnection(1, 2);  // User 1 and User 2 are friends
@@ -41,11 +1509,138 @@ int main() {
     cout << "Are User 1 and User 3 connected? ";
     cout << (network.isConnected(1, 3) ? "Yes" : "No") << endl;
 
+    // Freeze the graph into CSR form; later friendships go to the delta
+    network.freeze();
+    network.addConnection(3, 4);  // User 3 and User 4 become friends after the freeze
+
+    cout << "Friends of User 3:";
+    network.forEachFriend(3, [](int friendId) { cout << " " << friendId; });
+    cout << endl;
+
+    network.freeze();  // Merge the delta into the next snapshot
+    cout << "Are User 3 and User 4 connected? ";
+    cout << (network.isConnected(3, 4) ? "Yes" : "No") << endl;
+
+    // Unfriend events apply to both directions, whether the friendship is frozen or not
+    network.addConnection(1, 4);
+    network.removeConnection(4, 1);
+    network.removeConnection(3, 4);
+    cout << "After unfriending, are User 3 and User 4 connected? ";
+    cout << (network.isConnected(4, 3) ? "Yes" : "No") << endl;
+    network.addConnection(3, 4);  // Friends again
+
+    // Weighted friendships: a closeness score per pair, each pair stored once
+    BasicSparseMatrix<float> closeness(true);
+    closeness.addConnection(1, 2, 0.9f);
+    closeness.addConnection(3, 2, 0.4f);
+    closeness.freeze();
+    closeness.addConnection(2, 1, 0.7f);  // Update a frozen friendship in place
+    cout << "Closeness of User 1 and User 2: " << closeness.connection(1, 2).value_or(0) << endl;
+
+    // Check several pairs at once; unknown users (like 99) do not create rows
+    vector<pair<int, int>> queries = {{2, 3}, {1, 4}, {99, 1}, {2, 1}};
+    vector<bool> answers = network.areConnected(queries);
+    cout << "Batch lookup:";
+    for (size_t i = 0; i < queries.size(); ++i)
+        cout << " (" << queries[i].first << "," << queries[i].second << ")=" << (answers[i] ? "Yes" : "No");
+    cout << endl;
+
+    // Traversals on the frozen snapshot
+    network.addConnection(5, 6);  // A separate group of friends
+    network.freeze();
+    cout << "Users within 2 hops of User 1:";
+    for (int user : network.friendsWithinHops(1, 2)) cout << " " << user;
+    cout << endl;
+    cout << "Hops from User 1 to User 4: " << network.hopDistance(1, 4) << endl;
+    vector<int> component = network.connectedComponents();
+    cout << "Connected groups: " << *max_element(component.begin(), component.end()) + 1 << endl;
+
+    // Save the snapshot once; serving processes map the file instead of rebuilding the graph
+    if (network.saveSnapshot("friends.graph")) {
+        MappedGraph mapped;
+        if (mapped.open("friends.graph")) {
+            cout << "Mapped graph: " << mapped.view().rows() << " users, "
+                 << "User 5 and User 6 connected? " << (mapped.isConnected(5, 6) ? "Yes" : "No") << endl;
+        }
+    }
+
+    // Load a whole edge list at once instead of calling addConnection() per edge
+    ofstream("friends.edges") << "# user1 user2\n1 2\n2 3\n3 1\n2 1\n2 4\n4 5\n";
+    if (auto loaded = SparseMatrix::fromEdgeList("friends.edges")) {
+        cout << "Loaded " << loaded->snapshot.rows() << " users from the edge list, "
+             << "User 3 and User 1 connected? " << (loaded->isConnected(3, 1) ? "Yes" : "No") << endl;
+
+        // Mutual friends and triangles use vectorized sorted-set intersection
+        cout << "Mutual friends of User 1 and User 3:";
+        for (int user : loaded->mutualFriends(1, 3)) cout << " " << user;
+        cout << endl;
+        cout << "Triangles in the loaded graph: " << loaded->triangleCount() << endl;
+
+        // PageRank in single precision, on top of the sparse matrix-vector multiply
+        PageRankResult<float> scores = loaded->influence<float>();
+        int top = max_element(scores.rank.begin(), scores.rank.end()) - scores.rank.begin();
+        cout << "Most influential user: " << loaded->snapshot.ids[top] << " (PageRank "
+             << scores.rank[top] << " after " << scores.iterations << " iterations)" << endl;
+    }
+
+    // Locality: a 256 x 256 grid of friendships whose user ids are scattered at random,
+    // before and after relabeling the rows in Reverse Cuthill-McKee order
+    const int side = 256;
+    vector<int> scattered(side * side);
+    iota(scattered.begin(), scattered.end(), 0);
+    shuffle(scattered.begin(), scattered.end(), mt19937(7));
+    SparseMatrix grid;
+    for (int i = 0; i < side * side; ++i) {
+        if (i % side + 1 < side) grid.addConnection(scattered[i], scattered[i + 1]);
+        if (i + side < side * side) grid.addConnection(scattered[i], scattered[i + side]);
+    }
+    grid.freeze();
+    localityBenchmark(grid, "Id order");
+    grid.reorder(RowOrder::ReverseCuthillMcKee);
+    localityBenchmark(grid, "RCM order");
+    cout << "After relabeling, hops between opposite grid corners: "
+         << grid.hopDistance(scattered[0], scattered[side * side - 1]) << endl;
+
+    // Concurrent variant: readers check a fixed friendship while a writer churns others
+    ConcurrentSparseMatrix live(1000);
+    live.addConnection(0, 1);
+    atomic<bool> stop{false}, consistent{true};
+    vector<thread> readers;
+    for (int id = 0; id < 4; ++id) {
+        readers.emplace_back([&] {
+            while (!stop) {
+                if (!live.isConnected(0, 1) || !live.isConnected(1, 0)) consistent = false;
+            }
+        });
+    }
+    for (int i = 0; i < 20000; ++i) {
+        live.addConnection(1, 2 + i % 500);
+        live.removeConnection(1, 2 + (i * 7) % 500);
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+    cout << "Concurrent readers always saw User 0 and User 1 connected? " << (consistent ? "Yes" : "No") << endl;
+    for (int count : {1, 2, 4}) {
+        cout << count << " reader thread(s): "
+             << readerThroughput(live, 1000, count, chrono::milliseconds(100)) / 1e6 << " M lookups/s" << endl;
+    }
+
     return 0;
 }
 Explanation:
 This code uses a sparse matrix implemented as a hash map of hash maps.
 Only connected users are stored, reducing memory consumption.
+freeze() converts the map of maps into a compressed sparse row (CSR) snapshot: one sorted id array, one offsets array and one contiguous neighbor array, so an edge costs 4 bytes instead of a hash node.
+isConnected() gallops through the sorted neighbor row of the snapshot, and falls back to the map for connections added after the last freeze().
+Lookups are const and use find() instead of operator[], so asking about unknown users never inserts empty rows; areConnected() answers a whole batch grouped by row, galloping forward through each row from the previous answer.
+BasicSparseMatrix<Value> chooses what a friendship stores: SparseMatrix (Value = void) keeps no values at all, while e.g. BasicSparseMatrix<float> keeps one weight per friendship. removeConnection() unfriends in both directions, and the upper-triangle option stores each friendship once in the map instead of twice.
+BfsEngine runs a direction-optimizing BFS on the snapshot (top-down for small frontiers, bottom-up over a frontier bitmap for large ones), split across std::thread workers; it powers friendsWithinHops(), hopDistance() and connectedComponents(). friendsWithinHops() and hopDistance() reuse one engine per thread and clear only the rows the previous query reached, so a short query on a large graph costs what it visits.
+saveSnapshot() writes the CSR arrays in a versioned little-endian file (header, ids, offsets, neighbors, optional weights); MappedGraph maps that file and queries it in place, so startup needs no parsing: open() checks only the header and section bounds. open(path, true) also checks that the offsets are monotonic and every neighbor is a row, and refuses a corrupt file, at the cost of reading the whole file once.
+fromEdgeList() builds the snapshot from an edge list file in bulk: it streams the file in chunks, radix sorts the packed (user1, user2) pairs in parallel, removes duplicates and writes the CSR arrays in one pass.
+mutualFriends(), commonNeighborCount() and triangleCount() intersect sorted neighbor rows with SSE4.2 or AVX2 kernels (chosen at runtime from the CPU features) and fall back to a scalar merge elsewhere.
+spmv() multiplies the adjacency matrix by a vector, splitting rows between threads by edge count; pageRank() iterates it until the change drops below a tolerance, in float or double, with an optional personalized restart distribution.
+reorder() relabels the snapshot rows for cache locality (Reverse Cuthill-McKee, BFS or degree order) while snapshot.ids keeps translating rows back to user ids; friends then sit in nearby rows, so BFS and SpMV touch fewer cache lines. The demo prints the BFS and SpMV time (and hardware cache misses, where perf events are available) before and after.
+ConcurrentSparseMatrix serves many reader threads while writers add and remove friendships: rows are immutable sorted blocks published with an atomic pointer store, reads are wait-free, and replaced rows are freed by epoch-based reclamation once no reader can still see them. A reader's pin store and its row load are both sequentially consistent, so a writer scanning the pins cannot miss a reader that has already loaded a row. Guards may nest: only the outermost one pins and unpins the thread's slot.
 Checking if two users are connected takes constant time 
 𝑂
 (
@@ -66,8 +1661,800 @@ Copy code
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <tuple>
+#include <fstream>
+#include <string>
+#include <bit>
+#include <cstring>
+#include <climits>
+#include <random>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
+const double INF = numeric_limits<double>::infinity();
+
+// Read-only view of the contiguous routing layout, which may live in a RoadGraph
+// or directly in a memory-mapped graph file. Row r is city ids[r], and its roads
+// are targets[offsets[r]] .. targets[offsets[r + 1] - 1] with matching lengths.
+// If the rows were relabeled for locality, byId lists them in city id order.
+struct RoadView {
+    const int* ids = nullptr;           // Row -> city id
+    const uint64_t* offsets = nullptr;  // Row r spans [offsets[r], offsets[r + 1])
+    const int* targets = nullptr;       // Neighbor rows
+    const double* lengths = nullptr;    // Road length for each entry in targets
+    int rowCount = 0;
+    const int* byId = nullptr;          // Rows sorted by city id, or nullptr if ids is sorted
+
+    int rows() const { return rowCount; }
+    uint64_t roads() const { return rowCount ? offsets[rowCount] : 0; }
+
+    // Row of a city, or -1 if the city has no roads
+    int rowOf(int city) const {
+        if (byId) {
+            const int* it = lower_bound(byId, byId + rowCount, city, [&](int row, int id) { return ids[row] < id; });
+            return (it != byId + rowCount && ids[*it] == city) ? *it : -1;
+        }
+        const int* it = lower_bound(ids, ids + rowCount, city);
+        if (it == ids + rowCount || *it != city) return -1;
+        return it - ids;
+    }
+};
+
+// Routing layout built from the RoadMap, owning its arrays
+struct RoadGraph {
+    vector<int> ids;
+    vector<uint64_t> offsets;
+    vector<int> targets;
+    vector<double> lengths;
+    vector<int> byId;  // Rows sorted by city id; empty while ids itself is sorted
+
+    RoadView view() const {
+        return {ids.data(), offsets.data(), targets.data(), lengths.data(), rows(), byId.empty() ? nullptr : byId.data()};
+    }
+    int rows() const { return ids.size(); }
+    int rowOf(int city) const { return view().rowOf(city); }
+
+    // Rebuild byId after ids changed
+    void indexIds() {
+        byId.clear();
+        if (is_sorted(ids.begin(), ids.end())) return;
+        byId.resize(ids.size());
+        iota(byId.begin(), byId.end(), 0);
+        sort(byId.begin(), byId.end(), [&](int a, int b) { return ids[a] < ids[b]; });
+    }
+};
+
+// Row orders for relabeling a road graph so that nearby cities sit together in memory
+enum class RowOrder {
+    Id,                   // Ascending city id (the default layout)
+    Degree,               // Most roads first
+    Bfs,                  // Breadth-first, one connected region after another
+    ReverseCuthillMcKee,  // BFS from a low-degree row visiting neighbors by degree, reversed
+};
+
+// New row order for a road graph: result[newRow] = oldRow
+vector<int> localityOrder(RoadView g, RowOrder order) {
+    int n = g.rows();
+    vector<int> result(n);
+    iota(result.begin(), result.end(), 0);
+    auto degree = [&](int r) { return g.offsets[r + 1] - g.offsets[r]; };
+    auto byDegree = [&](int a, int b) { return degree(a) < degree(b); };
+    if (order == RowOrder::Id) {
+        sort(result.begin(), result.end(), [&](int a, int b) { return g.ids[a] < g.ids[b]; });
+    } else if (order == RowOrder::Degree) {
+        stable_sort(result.begin(), result.end(), [&](int a, int b) { return degree(a) > degree(b); });
+    } else {
+        bool rcm = order == RowOrder::ReverseCuthillMcKee;
+        vector<int> starts = result;
+        if (rcm) stable_sort(starts.begin(), starts.end(), byDegree);
+        vector<char> seen(n, 0);
+        result.clear();
+        for (int start : starts) {
+            if (seen[start]) continue;
+            seen[start] = 1;
+            result.push_back(start);
+            for (size_t head = result.size() - 1; head < result.size(); ++head) {
+                size_t discovered = result.size();
+                int u = result[head];
+                for (uint64_t k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                    int v = g.targets[k];
+                    if (!seen[v]) seen[v] = 1, result.push_back(v);
+                }
+                if (rcm) stable_sort(result.begin() + discovered, result.end(), byDegree);
+            }
+        }
+        if (rcm) reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+// Rewrite a road graph in a new row order (newToOld[newRow] = oldRow); cities keep their ids
+RoadGraph permuteRows(RoadView g, const vector<int>& newToOld) {
+    int n = g.rows();
+    vector<int> oldToNew(n);
+    for (int r = 0; r < n; ++r) oldToNew[newToOld[r]] = r;
+
+    RoadGraph result;
+    result.ids.resize(n);
+    result.offsets.reserve(n + 1);
+    result.offsets.push_back(0);
+    result.targets.reserve(g.roads());
+    result.lengths.reserve(g.roads());
+    vector<pair<int, double>> roads;
+    for (int r = 0; r < n; ++r) {
+        int old = newToOld[r];
+        result.ids[r] = g.ids[old];
+        roads.clear();
+        for (uint64_t k = g.offsets[old]; k < g.offsets[old + 1]; ++k) roads.push_back({oldToNew[g.targets[k]], g.lengths[k]});
+        sort(roads.begin(), roads.end());
+        for (const auto& road : roads) {
+            result.targets.push_back(road.first);
+            result.lengths.push_back(road.second);
+        }
+        result.offsets.push_back(result.targets.size());
+    }
+    result.indexIds();
+    return result;
+}
+
+// Indexed 4-ary min-heap of rows keyed by tentative distance. The four children of
+// a node sit next to each other in memory, and pos[] gives decrease-key without
+// duplicate entries. Storage is sized once per graph and reused by every query.
+class QuadHeap {
+public:
+    void resize(int rows) {
+        pos.assign(rows, -1);
+        heap.clear();
+        heap.reserve(rows);
+    }
+
+    bool empty() const { return heap.empty(); }
+    double topKey() const { return heap[0].key; }
+
+    // Remove leftovers from an early-terminated query
+    void clear() {
+        for (const Entry& e : heap) pos[e.row] = -1;
+        heap.clear();
+    }
+
+    // Insert a row, or lower its key if it is already queued
+    void push(int row, double key) {
+        int i = pos[row];
+        if (i == -1) {
+            i = heap.size();
+            heap.push_back({key, row});
+        } else {
+            heap[i].key = key;
+        }
+        siftUp(i);
+    }
+
+    int pop() {
+        int top = heap[0].row;
+        pos[top] = -1;
+        Entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            pos[last.row] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+private:
+    struct Entry {
+        double key;
+        int row;
+    };
+    vector<Entry> heap;
+    vector<int> pos;  // Row -> index in heap, -1 if not queued
+
+    void siftUp(int i) {
+        Entry e = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / 4;
+            if (heap[parent].key <= e.key) break;
+            heap[i] = heap[parent];
+            pos[heap[i].row] = i;
+            i = parent;
+        }
+        heap[i] = e;
+        pos[e.row] = i;
+    }
+
+    void siftDown(int i) {
+        Entry e = heap[i];
+        int n = heap.size();
+        while (true) {
+            int first = 4 * i + 1;
+            if (first >= n) break;
+            int best = first;
+            for (int c = first + 1; c < min(first + 4, n); ++c) {
+                if (heap[c].key < heap[best].key) best = c;
+            }
+            if (heap[best].key >= e.key) break;
+            heap[i] = heap[best];
+            pos[heap[i].row] = i;
+            i = best;
+        }
+        heap[i] = e;
+        pos[e.row] = i;
+    }
+};
+
+// Default heuristic: no estimate, which turns A* into plain Dijkstra
+struct NoHeuristic {
+    double operator()(int, int) const { return 0; }
+};
+
+// Dijkstra / A* search state. Arrays are sized once per graph; each query only
+// resets the rows it touched, so back-to-back queries allocate nothing.
+class Router {
+public:
+    void prepare(RoadView graph) {
+        dist.assign(graph.rows(), INF);
+        parent.assign(graph.rows(), -1);
+        settled.assign((graph.rows() + 63) / 64, 0);
+        touched.clear();
+        touched.reserve(graph.rows());
+        heap.resize(graph.rows());
+    }
+
+    // Shortest distance between two rows, or -1 if unreachable. The heuristic gets
+    // (city, target city) ids and must never overestimate the remaining distance;
+    // it must also be consistent (e.g. straight-line distance), because settled
+    // rows are never reopened.
+    template <typename Heuristic>
+    double search(RoadView g, int source, int target, Heuristic heuristic) {
+        reset();
+        if (source == -1 || target == -1) return -1;
+        const int goal = g.ids[target];
+        relax(source, 0, -1, heuristic(g.ids[source], goal));
+        while (!heap.empty()) {
+            int u = heap.pop();
+            settled[u >> 6] |= 1ULL << (u & 63);
+            if (u == target) break;
+            for (uint64_t k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                int v = g.targets[k];
+                if (settled[v >> 6] >> (v & 63) & 1) continue;
+                double d = dist[u] + g.lengths[k];
+                if (d < dist[v]) relax(v, d, u, d + heuristic(g.ids[v], goal));
+            }
+        }
+        heap.clear();
+        return dist[target] == INF ? -1 : dist[target];
+    }
+
+    // Rows on the path found by the last search, source first
+    vector<int> path(int target) const {
+        vector<int> rows;
+        if (target == -1 || dist[target] == INF) return rows;
+        for (int r = target; r != -1; r = parent[r]) rows.push_back(r);
+        reverse(rows.begin(), rows.end());
+        return rows;
+    }
+
+private:
+    vector<double> dist;
+    vector<int> parent;
+    vector<uint64_t> settled;  // Visited bitset
+    vector<int> touched;       // Rows whose dist/settled must be reset before the next query
+    QuadHeap heap;
+
+    void relax(int row, double d, int from, double key) {
+        if (dist[row] == INF) touched.push_back(row);
+        dist[row] = d;
+        parent[row] = from;
+        heap.push(row, key);
+    }
+
+    void reset() {
+        for (int r : touched) {
+            dist[r] = INF;
+            parent[r] = -1;
+            settled[r >> 6] = 0;
+        }
+        touched.clear();
+    }
+};
+
+struct Route {
+    double distance;     // -1 if there is no route
+    vector<int> cities;  // City ids from source to destination
+};
+
+// On-disk graph format (version 2), little-endian, every section 8-byte aligned:
+//   header | ids: int32[rows] | offsets: uint64[rows + 1] | neighbors: int32[edges] | weights: float64[edges]
+//   | byId: int32[rows]
+// Road files always carry the weights section (flags has GraphFileHeader::hasWeights);
+// byId is present only when flags has GraphFileHeader::hasRowIndex (rows relabeled).
+// Version 1 files have neither byIdAt nor byId and are still accepted.
+// Readers mmap the file and use the sections in place, so startup does no parsing
+// and every process serving the same file shares one copy in the page cache.
+struct GraphFileHeader {
+    static constexpr char expectedMagic[8] = {'S', 'P', 'G', 'R', 'A', 'P', 'H', 0};
+    static constexpr uint32_t currentVersion = 2;
+    static constexpr uint32_t hasWeights = 1;
+    static constexpr uint32_t hasRowIndex = 2;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t rows;
+    uint64_t edges;
+    uint64_t idsAt, offsetsAt, neighborsAt, weightsAt;  // Byte offsets from the start of the file
+    uint64_t byIdAt;                                     // Since version 2
+};
+
+inline uint64_t alignTo8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+// Whether the arrays of a mapped graph file can be queried safely: offsets start at
+// 0, never decrease and end at the edge count, and every neighbor and byId entry is
+// a row. This reads the whole file, O(rows + edges), so opening runs it only on request.
+inline bool consistentCsr(const uint64_t* offsets, const int* neighbors, int rows, uint64_t edges, const int* byId) {
+    if (offsets[0] != 0 || offsets[rows] != edges) return false;
+    for (int r = 0; r < rows; ++r) {
+        if (offsets[r] > offsets[r + 1]) return false;
+    }
+    auto isRow = [&](int r) { return r >= 0 && r < rows; };
+    return all_of(neighbors, neighbors + edges, isRow) && (!byId || all_of(byId, byId + rows, isRow));
+}
+
+// Write the routing layout in the on-disk format
+bool writeGraphFile(const string& path, RoadView graph) {
+    if constexpr (endian::native != endian::little) return false;  // The format is little-endian only
+    GraphFileHeader header = {};
+    memcpy(header.magic, GraphFileHeader::expectedMagic, sizeof(header.magic));
+    header.version = GraphFileHeader::currentVersion;
+    header.flags = GraphFileHeader::hasWeights | (graph.byId ? GraphFileHeader::hasRowIndex : 0);
+    header.rows = graph.rows();
+    header.edges = graph.roads();
+    header.idsAt = alignTo8(sizeof(header));
+    header.offsetsAt = alignTo8(header.idsAt + header.rows * sizeof(int));
+    header.neighborsAt = header.offsetsAt + (header.rows + 1) * sizeof(uint64_t);
+    header.weightsAt = alignTo8(header.neighborsAt + header.edges * sizeof(int));
+    header.byIdAt = graph.byId ? header.weightsAt + header.edges * sizeof(double) : 0;
+
+    ofstream out(path, ios::binary);
+    auto section = [&](uint64_t at, const void* bytes, uint64_t size) {
+        static const char zeros[8] = {};
+        out.write(zeros, at - uint64_t(out.tellp()));  // Padding up to the section
+        out.write(static_cast<const char*>(bytes), size);
+    };
+    const uint64_t emptyOffsets[1] = {0};
+    section(0, &header, sizeof(header));
+    section(header.idsAt, graph.ids, header.rows * sizeof(int));
+    section(header.offsetsAt, graph.rows() ? graph.offsets : emptyOffsets, (header.rows + 1) * sizeof(uint64_t));
+    section(header.neighborsAt, graph.targets, header.edges * sizeof(int));
+    section(header.weightsAt, graph.lengths, header.edges * sizeof(double));
+    if (graph.byId) section(header.byIdAt, graph.byId, header.rows * sizeof(int));
+    return bool(out);
+}
+
+// A road graph file mapped read-only into memory; lookups and routing run in place
+class MappedRoadGraph {
+public:
+    MappedRoadGraph() = default;
+    MappedRoadGraph(const MappedRoadGraph&) = delete;
+    MappedRoadGraph& operator=(const MappedRoadGraph&) = delete;
+    ~MappedRoadGraph() { close(); }
+
+    // Map a graph file. The header and section bounds are always checked, in O(1).
+    // With verify, every offset, neighbor and byId entry is checked as well: a
+    // corrupt file then cannot open, but the whole file is read once, O(rows + edges),
+    // instead of being paged in lazily. Use it for files from untrusted sources.
+    bool open(const string& path, bool verify = false) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && uint64_t(info.st_size) >= sizeof(GraphFileHeader)) {
+            length = info.st_size;
+            base = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);  // The mapping stays valid after the descriptor is closed
+        if (base == MAP_FAILED || !validate(verify)) {
+            close();
+            return false;
+        }
+        router.prepare(graph);
+        return true;
+    }
+
+    void close() {
+        if (base != MAP_FAILED) munmap(base, length);
+        base = MAP_FAILED;
+        length = 0;
+        graph = RoadView();
+    }
+
+    RoadView view() const { return graph; }
+
+    // Direct road length, or -1 if there is no direct road
+    double getDistance(int city1, int city2) const {
+        int row1 = graph.rowOf(city1), row2 = graph.rowOf(city2);
+        if (row1 == -1 || row2 == -1) return -1;
+        const int* first = graph.targets + graph.offsets[row1];
+        const int* last = graph.targets + graph.offsets[row1 + 1];
+        const int* it = lower_bound(first, last, row2);
+        return (it != last && *it == row2) ? graph.lengths[it - graph.targets] : -1;
+    }
+
+    template <typename Heuristic = NoHeuristic>
+    double shortestDistance(int src, int dst, Heuristic heuristic = Heuristic()) {
+        return router.search(graph, graph.rowOf(src), graph.rowOf(dst), heuristic);
+    }
+
+private:
+    void* base = MAP_FAILED;
+    size_t length = 0;
+    RoadView graph;
+    Router router;
+
+    // Check the header and that every section lies inside the file, and with verify
+    // that the arrays are consistent (queries index them directly)
+    bool validate(bool verify) {
+        if constexpr (endian::native != endian::little) return false;
+        const char* bytes = static_cast<const char*>(base);
+        const auto* header = reinterpret_cast<const GraphFileHeader*>(bytes);
+        if (memcmp(header->magic, GraphFileHeader::expectedMagic, sizeof(header->magic)) != 0) return false;
+        if (header->version < 1 || header->version > GraphFileHeader::currentVersion) return false;
+        if (header->rows > uint64_t(INT_MAX)) return false;
+        if (!(header->flags & GraphFileHeader::hasWeights)) return false;  // Roads need lengths
+        auto fits = [&](uint64_t at, uint64_t count, uint64_t size) {
+            return at % 8 == 0 && at <= length && count <= (length - at) / size;
+        };
+        bool indexed = header->version >= 2 && (header->flags & GraphFileHeader::hasRowIndex);
+        if (!fits(header->idsAt, header->rows, sizeof(int)) ||
+            !fits(header->offsetsAt, header->rows + 1, sizeof(uint64_t)) ||
+            !fits(header->neighborsAt, header->edges, sizeof(int)) ||
+            !fits(header->weightsAt, header->edges, sizeof(double)) ||
+            (indexed && !fits(header->byIdAt, header->rows, sizeof(int))))
+            return false;
+        graph.ids = reinterpret_cast<const int*>(bytes + header->idsAt);
+        graph.offsets = reinterpret_cast<const uint64_t*>(bytes + header->offsetsAt);
+        graph.targets = reinterpret_cast<const int*>(bytes + header->neighborsAt);
+        graph.lengths = reinterpret_cast<const double*>(bytes + header->weightsAt);
+        graph.rowCount = header->rows;
+        graph.byId = indexed ? reinterpret_cast<const int*>(bytes + header->byIdAt) : nullptr;
+        if (graph.offsets[graph.rowCount] != header->edges) return false;
+        return !verify || consistentCsr(graph.offsets, graph.targets, graph.rowCount, header->edges, graph.byId);
+    }
+};
+
+// Contraction hierarchy (CH) over a RoadGraph. Preprocessing contracts the
+// cities one by one, least important first, adding a shortcut u-w whenever
+// removing v would destroy the only shortest path u-v-w. Each city keeps only
+// its edges to cities contracted after it (the upward graph); since roads are
+// bidirectional, the same upward graph serves both directions of a query.
+class ContractionHierarchy {
+public:
+    vector<int> ids;           // Row -> city id
+    vector<uint64_t> offsets;  // Upward edges of row r: [offsets[r], offsets[r + 1])
+    vector<int> targets;       // Higher-ranked row at the other end
+    vector<double> lengths;
+    vector<int> middle;        // Row a shortcut bypasses, -1 for an original road
+    int settledLastQuery = 0;  // Rows settled by the last query, both directions together
+
+    static ContractionHierarchy build(RoadView g) {
+        struct Arc {
+            int to;
+            double length;
+            int middle;
+        };
+        const int n = g.rows();
+        vector<vector<Arc>> adj(n);  // Remaining (uncontracted) graph
+        for (int u = 0; u < n; ++u) {
+            for (uint64_t k = g.offsets[u]; k < g.offsets[u + 1]; ++k) {
+                if (g.targets[k] != u) adj[u].push_back({g.targets[k], g.lengths[k], -1});
+            }
+        }
+
+        // Witness search: bounded Dijkstra from u that avoids v
+        vector<double> dist(n, INF);
+        vector<int> touched;
+        QuadHeap heap;
+        heap.resize(n);
+        const int maxSettled = 500;
+        auto witnessSearch = [&](int u, int v, double limit) {
+            for (int r : touched) dist[r] = INF;
+            touched.assign(1, u);
+            dist[u] = 0;
+            heap.push(u, 0);
+            for (int settled = 0; !heap.empty() && settled < maxSettled; ++settled) {
+                int x = heap.pop();
+                if (dist[x] > limit) break;
+                for (const Arc& a : adj[x]) {
+                    if (a.to == v || dist[x] + a.length >= dist[a.to]) continue;
+                    if (dist[a.to] == INF) touched.push_back(a.to);
+                    dist[a.to] = dist[x] + a.length;
+                    heap.push(a.to, dist[a.to]);
+                }
+            }
+            heap.clear();
+        };
+
+        // Shortcuts (u, w, length) needed to contract v
+        vector<tuple<int, int, double>> shortcuts;
+        auto findShortcuts = [&](int v) {
+            shortcuts.clear();
+            for (const Arc& in : adj[v]) {
+                double limit = -1;  // Stays negative when no pair (in, out) remains; 0 is a real limit
+                for (const Arc& out : adj[v]) {
+                    if (out.to > in.to) limit = max(limit, in.length + out.length);
+                }
+                if (limit < 0) continue;
+                witnessSearch(in.to, v, limit);
+                for (const Arc& out : adj[v]) {
+                    if (out.to > in.to && dist[out.to] > in.length + out.length)
+                        shortcuts.push_back({in.to, out.to, in.length + out.length});
+                }
+            }
+        };
+
+        // Importance: edge difference plus the number of already contracted neighbors
+        vector<int> deletedNeighbors(n, 0);
+        auto priority = [&](int v) {
+            findShortcuts(v);
+            return int(shortcuts.size()) - int(adj[v].size()) + deletedNeighbors[v];
+        };
+
+        auto addArc = [&](int from, int to, double length, int via) {
+            for (Arc& a : adj[from]) {
+                if (a.to == to) {
+                    if (length < a.length) a = {to, length, via};
+                    return;
+                }
+            }
+            adj[from].push_back({to, length, via});
+        };
+
+        priority_queue<pair<int, int>, vector<pair<int, int>>, greater<>> order;
+        for (int v = 0; v < n; ++v) order.push({priority(v), v});
+
+        vector<vector<Arc>> up(n);
+        while (!order.empty()) {
+            int v = order.top().second;
+            order.pop();
+            // Lazy update: priorities go stale as neighbors are contracted
+            int current = priority(v);
+            if (!order.empty() && current > order.top().first) {
+                order.push({current, v});
+                continue;
+            }
+
+            up[v] = adj[v];  // Every remaining neighbor is contracted later, so ranks higher
+            for (const Arc& a : adj[v]) {
+                auto& back = adj[a.to];
+                back.erase(find_if(back.begin(), back.end(), [&](const Arc& b) { return b.to == v; }));
+                ++deletedNeighbors[a.to];
+            }
+            for (const auto& [u, w, length] : shortcuts) {
+                addArc(u, w, length, v);
+                addArc(w, u, length, v);
+            }
+            adj[v].clear();
+            adj[v].shrink_to_fit();
+        }
+
+        ContractionHierarchy ch;
+        ch.ids.assign(g.ids, g.ids + n);
+        ch.indexIds();
+        ch.offsets.push_back(0);
+        for (int v = 0; v < n; ++v) {
+            for (const Arc& a : up[v]) {
+                ch.targets.push_back(a.to);
+                ch.lengths.push_back(a.length);
+                ch.middle.push_back(a.middle);
+            }
+            ch.offsets.push_back(ch.targets.size());
+        }
+        return ch;
+    }
+
+    // Binary file: magic, version, row and edge counts, then the arrays as stored
+    // in memory (host byte order)
+    bool save(const string& path) const {
+        ofstream out(path, ios::binary);
+        if (!out) return false;
+        uint64_t header[4] = {fileMagic, fileVersion, ids.size(), targets.size()};
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        writeArray(out, ids);
+        writeArray(out, offsets);
+        writeArray(out, targets);
+        writeArray(out, lengths);
+        writeArray(out, middle);
+        return bool(out);
+    }
+
+    // Returns false on a missing, truncated or corrupt file; queries index the arrays
+    // directly, so offsets, targets and middle rows are checked before they are used
+    bool load(const string& path) {
+        ifstream in(path, ios::binary | ios::ate);
+        uint64_t header[4];
+        uint64_t available = in ? uint64_t(in.tellg()) : 0;
+        if (!in.seekg(0) || !in.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+        if (header[0] != fileMagic || header[1] != fileVersion) return false;
+        // Counts must fit in the rest of the file before anything is allocated
+        available -= sizeof(header);
+        if (header[2] >= uint64_t(INT_MAX) || header[2] > available / (sizeof(int) + sizeof(uint64_t)) ||
+            header[3] > available / (2 * sizeof(int) + sizeof(double)))
+            return false;
+        ids.resize(header[2]);
+        offsets.resize(header[2] + 1);
+        targets.resize(header[3]);
+        lengths.resize(header[3]);
+        middle.resize(header[3]);
+        if (!readArray(in, ids) || !readArray(in, offsets) || !readArray(in, targets) || !readArray(in, lengths) ||
+            !readArray(in, middle))
+            return false;
+        if (!validate()) return false;
+        indexIds();
+        return true;
+    }
+
+    // Shortest distance between two cities, or -1 if there is no route.
+    // Both searches only follow upward edges and meet at the highest-ranked city
+    // of the shortest path.
+    double distance(int src, int dst) {
+        int s = rowOf(src), t = rowOf(dst);
+        meet = -1;  // route() must not unpack the previous query's path
+        settledLastQuery = 0;
+        if (s == -1 || t == -1) return -1;
+        if (forward.dist.size() != ids.size()) {
+            forward.prepare(ids.size());
+            backward.prepare(ids.size());
+        }
+        forward.reset();
+        backward.reset();
+        best = INF;
+        forward.relax(s, 0, -1);
+        backward.relax(t, 0, -1);
+        while (true) {
+            bool forwardActive = !forward.heap.empty() && forward.heap.topKey() < best;
+            bool backwardActive = !backward.heap.empty() && backward.heap.topKey() < best;
+            if (!forwardActive && !backwardActive) break;
+            bool useForward = forwardActive && (!backwardActive || forward.heap.topKey() <= backward.heap.topKey());
+            Search& side = useForward ? forward : backward;
+            Search& other = useForward ? backward : forward;
+
+            int u = side.heap.pop();
+            ++settledLastQuery;
+            if (other.dist[u] != INF && side.dist[u] + other.dist[u] < best) {
+                best = side.dist[u] + other.dist[u];
+                meet = u;
+            }
+            for (uint64_t k = offsets[u]; k < offsets[u + 1]; ++k) {
+                double d = side.dist[u] + lengths[k];
+                if (d < side.dist[targets[k]]) side.relax(targets[k], d, u);
+            }
+        }
+        forward.heap.clear();
+        backward.heap.clear();
+        return meet == -1 ? -1 : best;
+    }
+
+    // Shortest route with shortcuts unpacked back into original roads
+    Route route(int src, int dst) {
+        Route result{distance(src, dst), {}};
+        if (meet == -1) return result;
+        vector<int> rows;
+        for (int r = meet; r != -1; r = forward.parent[r]) rows.push_back(r);
+        reverse(rows.begin(), rows.end());
+        for (int r = backward.parent[meet]; r != -1; r = backward.parent[r]) rows.push_back(r);
+
+        vector<int> unpacked = {rows[0]};
+        for (size_t i = 1; i < rows.size(); ++i) unpack(rows[i - 1], rows[i], unpacked);
+        for (int r : unpacked) result.cities.push_back(ids[r]);
+        return result;
+    }
+
+private:
+    static constexpr uint64_t fileMagic = 0x48434452;  // "RDCH"
+    static constexpr uint64_t fileVersion = 1;
+
+    // One direction of the bidirectional query; only touched rows are reset
+    struct Search {
+        vector<double> dist;
+        vector<int> parent;
+        vector<int> touched;
+        QuadHeap heap;
+
+        void prepare(int rows) {
+            dist.assign(rows, INF);
+            parent.assign(rows, -1);
+            touched.reserve(rows);
+            heap.resize(rows);
+        }
+        void reset() {
+            for (int r : touched) {
+                dist[r] = INF;
+                parent[r] = -1;
+            }
+            touched.clear();
+        }
+        void relax(int row, double d, int from) {
+            if (dist[row] == INF) touched.push_back(row);
+            dist[row] = d;
+            parent[row] = from;
+            heap.push(row, d);
+        }
+    };
+
+    Search forward, backward;
+    double best = INF;
+    int meet = -1;
+
+    vector<int> byId;  // Rows sorted by city id, rebuilt on build/load; empty while ids is sorted
+
+    void indexIds() {
+        byId.clear();
+        if (is_sorted(ids.begin(), ids.end())) return;
+        byId.resize(ids.size());
+        iota(byId.begin(), byId.end(), 0);
+        sort(byId.begin(), byId.end(), [&](int a, int b) { return ids[a] < ids[b]; });
+    }
+
+    int rowOf(int city) const {
+        if (!byId.empty()) {
+            auto it = lower_bound(byId.begin(), byId.end(), city, [&](int row, int id) { return ids[row] < id; });
+            return (it != byId.end() && ids[*it] == city) ? *it : -1;
+        }
+        auto it = lower_bound(ids.begin(), ids.end(), city);
+        if (it == ids.end() || *it != city) return -1;
+        return it - ids.begin();
+    }
+
+    // Offsets start at 0, never decrease and end at the edge count; targets and the
+    // rows shortcuts bypass are rows of this hierarchy
+    bool validate() const {
+        int n = ids.size();
+        if (offsets.front() != 0 || offsets.back() != targets.size()) return false;
+        if (adjacent_find(offsets.begin(), offsets.end(), greater<uint64_t>()) != offsets.end()) return false;
+        auto isRow = [&](int r) { return r >= 0 && r < n; };
+        return all_of(targets.begin(), targets.end(), isRow) &&
+               all_of(middle.begin(), middle.end(), [&](int r) { return r == -1 || isRow(r); });
+    }
+
+    // Append the original roads behind the upward edge between a and b (a already emitted)
+    void unpack(int a, int b, vector<int>& out) const {
+        int via = -1;
+        for (int from : {a, b}) {
+            int to = (from == a) ? b : a;
+            for (uint64_t k = offsets[from]; k < offsets[from + 1]; ++k) {
+                if (targets[k] == to) via = middle[k];
+            }
+        }
+        if (via == -1) {
+            out.push_back(b);
+            return;
+        }
+        unpack(a, via, out);
+        unpack(via, b, out);
+    }
+
+    template <typename T>
+    static void writeArray(ofstream& out, const vector<T>& values) {
+        out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    static bool readArray(ifstream& in, vector<T>& values) {
+        return bool(in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T)));
+    }
+};
+
 // Sparse matrix to represent roads as graph
 class RoadMap {
 public:
@@ -76,16 +2463,113 @@ public:
     void addRoad(int city1, int city2, double distance) {
         data[city1][city2] = distance;
         data[city2][city1] = distance;  // Assuming bidirectional roads
+        dirty = true;
     }
 
-    double getDistance(int city1, int city2) {
-        if (data[city1].count(city2))
-            return data[city1][city2];
-        else
-            return -1;  // No direct road
+    // Read-only lookup of a direct road: one find() per level, no inserts
+    optional<double> findDistance(int city1, int city2) const {
+        auto row = data.find(city1);
+        if (row == data.end()) return nullopt;
+        auto road = row->second.find(city2);
+        if (road == row->second.end()) return nullopt;
+        return road->second;
     }
+
+    double getDistance(int city1, int city2) const {
+        return findDistance(city1, city2).value_or(-1);  // -1: no direct road
+    }
+
+    // Rebuild the contiguous routing graph from the map
+    void freeze() {
+        graph = RoadGraph();
+        graph.ids.reserve(data.size());
+        for (const auto& row : data) graph.ids.push_back(row.first);
+        sort(graph.ids.begin(), graph.ids.end());
+
+        graph.offsets.reserve(graph.rows() + 1);
+        graph.offsets.push_back(0);
+        vector<pair<int, double>> roads;
+        for (int city : graph.ids) {
+            roads.clear();
+            for (const auto& road : data.at(city)) roads.push_back({graph.rowOf(road.first), road.second});
+            sort(roads.begin(), roads.end());
+            for (const auto& road : roads) {
+                graph.targets.push_back(road.first);
+                graph.lengths.push_back(road.second);
+            }
+            graph.offsets.push_back(graph.targets.size());
+        }
+        if (order != RowOrder::Id) graph = permuteRows(graph.view(), localityOrder(graph.view(), order));
+        router.prepare(graph.view());
+        dirty = false;
+    }
+
+    // Lay the routing graph out in a locality-improving row order from the next freeze()
+    // on. City ids are unchanged; only the position of each city's roads in memory moves.
+    void setRowOrder(RowOrder rowOrder) {
+        order = rowOrder;
+        dirty = true;
+    }
+
+    // Length of the shortest route between two cities, or -1 if there is none.
+    // Pass a heuristic (city, destination) -> lower bound on the remaining
+    // distance to run A* instead of Dijkstra.
+    template <typename Heuristic = NoHeuristic>
+    double shortestDistance(int src, int dst, Heuristic heuristic = Heuristic()) {
+        if (dirty) freeze();
+        return router.search(graph.view(), graph.rowOf(src), graph.rowOf(dst), heuristic);
+    }
+
+    template <typename Heuristic = NoHeuristic>
+    Route shortestPath(int src, int dst, Heuristic heuristic = Heuristic()) {
+        Route route{shortestDistance(src, dst, heuristic), {}};
+        for (int row : router.path(graph.rowOf(dst))) route.cities.push_back(graph.ids[row]);
+        return route;
+    }
+
+    // The contiguous layout (rebuilt if needed), e.g. for ContractionHierarchy::build()
+    RoadView routingGraph() {
+        if (dirty) freeze();
+        return graph.view();
+    }
+
+    // Write the routing layout in the mmap-able graph file format
+    bool saveGraph(const string& path) {
+        return writeGraphFile(path, routingGraph());
+    }
+
+private:
+    RoadGraph graph;
+    Router router;
+    bool dirty = true;  // The map changed since the last freeze()
+    RowOrder order = RowOrder::Id;
 };
 
+// Differential check of ContractionHierarchy against Dijkstra on random maps where
+// about one road in five has length 0, 1 or 2: zero-length roads and ties are where
+// shortcut and witness searches go wrong. A few queried ids are not on the map and
+// must give -1 with an empty route. Returns how many queries agreed.
+int checkHierarchyAgainstDijkstra(int maps = 10, int queriesPerMap = 200) {
+    mt19937 rng(5);
+    int agreed = 0;
+    for (int m = 0; m < maps; ++m) {
+        const int cities = 100;
+        RoadMap map;
+        for (int r = 0; r < 300; ++r) {
+            int a = rng() % cities, b = rng() % cities;
+            if (a != b) map.addRoad(a, b, rng() % 5 == 0 ? rng() % 3 : 1 + rng() % 100);
+        }
+        ContractionHierarchy hierarchy = ContractionHierarchy::build(map.routingGraph());
+        for (int q = 0; q < queriesPerMap; ++q) {
+            int src = rng() % (cities + 5), dst = rng() % (cities + 5);
+            Route fast = hierarchy.route(src, dst);
+            bool same = fast.distance == map.shortestDistance(src, dst);
+            agreed += same && (fast.distance != -1 || fast.cities.empty());
+        }
+    }
+    return agreed;
+}
+
 int main() {
     RoadMap map;
     map.addRoad(1, 2, 10.5);  // Road between city 1 and 2 with distance 10.5
@@ -94,11 +2578,55 @@ int main() {
     cout << "Distance between City 1 and City 2: " << map.getDistance(1, 2) << " km" << endl;
     cout << "Distance between City 1 and City 3: " << map.getDistance(1, 3) << " km" << endl;
 
+    // Shortest route: there is no direct road from 1 to 3, but there are routes through 2 and 4
+    map.addRoad(1, 4, 4.0);
+    map.addRoad(4, 3, 11.0);
+    Route route = map.shortestPath(1, 3);
+    cout << "Shortest route from City 1 to City 3: " << route.distance << " km via";
+    for (int city : route.cities) cout << " " << city;
+    cout << endl;
+
+    // A* with straight-line distance as the heuristic
+    unordered_map<int, pair<double, double>> position = {{1, {0, 0}}, {2, {10, 0}}, {3, {13, 4}}, {4, {3, 1}}};
+    auto straightLine = [&](int city, int goal) {
+        return hypot(position[city].first - position[goal].first, position[city].second - position[goal].second);
+    };
+    cout << "A* distance from City 1 to City 3: " << map.shortestDistance(1, 3, straightLine) << " km" << endl;
+
+    // Offline: build the contraction hierarchy once and save it.
+    // Serving: load it at startup and answer queries with a tiny bidirectional search.
+    ContractionHierarchy::build(map.routingGraph()).save("roads.ch");
+    ContractionHierarchy hierarchy;
+    if (hierarchy.load("roads.ch")) {
+        Route fast = hierarchy.route(1, 3);
+        cout << "CH route from City 1 to City 3: " << fast.distance << " km via";
+        for (int city : fast.cities) cout << " " << city;
+        cout << " (" << hierarchy.settledLastQuery << " cities settled)" << endl;
+    }
+    cout << "CH agrees with Dijkstra on maps with zero-length roads: " << checkHierarchyAgainstDijkstra()
+         << " of 2000 queries" << endl;
+
+    // Serving processes can also map the plain road graph and route on it in place.
+    // Relabel it first, so cities reached together are stored together.
+    map.setRowOrder(RowOrder::ReverseCuthillMcKee);
+    if (map.saveGraph("roads.graph")) {
+        MappedRoadGraph mapped;
+        if (mapped.open("roads.graph")) {
+            cout << "Mapped road graph: City 2 to City 3 is " << mapped.getDistance(2, 3) << " km, "
+                 << "route from City 1 to City 3 is " << mapped.shortestDistance(1, 3) << " km" << endl;
+        }
+    }
+
     return 0;
 }
 Explanation:
 This code uses a sparse matrix to store distances between cities.
 If there is no direct road, the entry is omitted, saving memory.
+findDistance() is a const, find-based lookup that returns an optional, so missing cities are not inserted into the map.
+shortestPath() routes between cities with no direct road: freeze() lays the roads out contiguously, and Dijkstra (or A* when a heuristic is passed) runs over that layout with an indexed 4-ary heap. The search arrays are reused, so repeated queries allocate nothing.
+ContractionHierarchy preprocesses the road graph offline (node ordering by edge difference, shortcut edges, upward graph) and saves it to a file; queries then run a bidirectional search over upward edges only, which settles very few cities even on large maps. Contraction also adds shortcuts around zero-length roads, and checkHierarchyAgainstDijkstra() compares CH routes with Dijkstra on random maps that have them. load() returns false on a truncated or corrupt file: counts must fit in the file, offsets must be monotonic, and targets and shortcut middles must be rows.
+setRowOrder() relabels the routing layout (Reverse Cuthill-McKee, BFS or degree order) so that cities reached together sit together in memory; a byId index keeps city id lookups working, and the contraction hierarchy and mapped files carry it along.
+saveGraph() writes the routing layout in the same versioned, little-endian file format as the friend graph (with the weights section); MappedRoadGraph maps it and answers getDistance() and shortestDistance() directly from the mapped arrays. open(path, true) runs the same optional consistency check as MappedGraph.
 The road distances are stored in a map, and access is in constant time 
 𝑂
 (
@@ -20,67 +20,1725 @@ coeff[] = {7, 5, 3, 4} // Coefficients in increasing order of exponents: 0, 1, 2
 Below, we will implement a **Polynomial class** that supports:
 1. Polynomial addition
 2. Polynomial evaluation at a given value of `x`
+3. Sparse storage for high-degree polynomials with few terms
+4. Polynomial multiplication (schoolbook, Karatsuba or NTT by size)
+5. Coefficient types other than `int`: modular, 128-bit, floating-point and overflow-checked
+6. In-place `+=`, `-=`, `*=` and chained sums that reuse temporaries
+7. Division with remainder, GCD and powers modulo a polynomial
+8. Sparse multivariate polynomials (`MultiPolynomial`)
 
 ```cpp
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <span>
+#include <bit>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <array>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
-class Polynomial {
+// Integers modulo an odd prime P < 2^31, kept in Montgomery form (value * 2^32 mod P)
+// so that a product needs no division: one 64-bit multiply and one Montgomery
+// reduction.
+template <uint32_t P>
+class ModInt {
+    static_assert(P % 2 == 1 && P < (1u << 31), "P must be an odd prime below 2^31");
+
+public:
+    ModInt() = default;
+    ModInt(int64_t x) : v(reduce(uint64_t(x % int64_t(P) + P) * r2)) {}
+
+    uint32_t value() const { return reduce(v); }
+
+    ModInt operator+(ModInt o) const { return raw(v + o.v >= P ? v + o.v - P : v + o.v); }
+    ModInt operator-(ModInt o) const { return raw(v >= o.v ? v - o.v : v + P - o.v); }
+    ModInt operator*(ModInt o) const { return raw(reduce(uint64_t(v) * o.v)); }
+    ModInt operator-() const { return raw(v ? P - v : 0); }
+    ModInt inverse() const {  // x^(P - 2) = x^-1 by Fermat's little theorem; 0 for 0
+        ModInt result = 1, x = *this;
+        for (uint32_t n = P - 2; n; n >>= 1, x *= x) {
+            if (n & 1) result *= x;
+        }
+        return result;
+    }
+    ModInt& operator+=(ModInt o) { return *this = *this + o; }
+    ModInt& operator-=(ModInt o) { return *this = *this - o; }
+    ModInt& operator*=(ModInt o) { return *this = *this * o; }
+    bool operator==(const ModInt&) const = default;
+
+    friend ostream& operator<<(ostream& out, ModInt x) { return out << x.value(); }
+
+private:
+    uint32_t v = 0;
+
+    // -P^-1 mod 2^32 by Newton's iteration (each step doubles the correct low bits)
+    static constexpr uint32_t negInverse = [] {
+        uint32_t inverse = P;
+        for (int i = 0; i < 4; ++i) inverse *= 2 - P * inverse;
+        return -inverse;
+    }();
+    static constexpr uint32_t r2 = (uint64_t(1) << 32) % P * ((uint64_t(1) << 32) % P) % P;  // 2^64 mod P
+
+    // t * 2^-32 mod P, for t < P * 2^32
+    static uint32_t reduce(uint64_t t) {
+        uint32_t m = uint32_t(t) * negInverse;
+        uint32_t r = (t + uint64_t(m) * P) >> 32;
+        return r >= P ? r - P : r;
+    }
+
+    static ModInt raw(uint32_t montgomery) {
+        ModInt x;
+        x.v = montgomery;
+        return x;
+    }
+};
+
+// Integer coefficient that throws overflow_error instead of wrapping, for results
+// that must be exact
+template <typename T>
+class Checked {
+public:
+    Checked() = default;
+    Checked(T x) : v(x) {}
+
+    T value() const { return v; }
+
+    Checked operator+(Checked o) const {
+        T r;
+        if (__builtin_add_overflow(v, o.v, &r)) overflow();
+        return r;
+    }
+    Checked operator-(Checked o) const {
+        T r;
+        if (__builtin_sub_overflow(v, o.v, &r)) overflow();
+        return r;
+    }
+    Checked operator*(Checked o) const {
+        T r;
+        if (__builtin_mul_overflow(v, o.v, &r)) overflow();
+        return r;
+    }
+    Checked operator-() const { return Checked(0) - *this; }
+    Checked& operator+=(Checked o) { return *this = *this + o; }
+    Checked& operator-=(Checked o) { return *this = *this - o; }
+    Checked& operator*=(Checked o) { return *this = *this * o; }
+    bool operator==(const Checked&) const = default;
+
+    friend ostream& operator<<(ostream& out, Checked x) { return out << x.v; }
+
 private:
-    vector<int> coeff;  // Array to store coefficients
+    T v = 0;
+
+    [[noreturn]] static void overflow() { throw overflow_error("polynomial coefficient overflow"); }
+};
+
+// Print a 128-bit integer (the standard streams have no overload for it)
+ostream& operator<<(ostream& out, __int128 value) {
+    unsigned __int128 magnitude = value < 0 ? -(unsigned __int128)value : value;
+    char digits[40], *first = digits + sizeof(digits);
+    do {
+        *--first = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) *--first = '-';
+    return out.write(first, digits + sizeof(digits) - first);
+}
+
+// How each coefficient type is handled by the kernels:
+//   Ring      - the type the loops compute in. Signed integers use their unsigned
+//               counterpart, so sums and products wrap instead of overflowing.
+//   exactNtt  - values fit in 31 bits, so products can go through the three-prime
+//               NTT and come back exact (toInteger / fromInteger convert).
+//   karatsuba - Karatsuba may be used. Not for Checked, whose intermediate sums
+//               can overflow even when the true product does not.
+//   field     - every nonzero value has an inverse, so GCDs are defined.
+//   invertible / inverse - which leading coefficients a divisor may have.
+template <typename T>
+struct CoefficientTraits {
+    using Ring = T;
+    static constexpr bool exactNtt = false;
+    static constexpr bool karatsuba = true;
+    static constexpr bool field = false;
+    static bool invertible(Ring x) { return x == Ring(1) || x == -Ring(1); }
+    static Ring inverse(Ring x) { return x; }
+};
+
+// Inverse of an odd x modulo 2^bits by Newton's iteration: x is its own inverse to
+// 3 bits, and each step doubles the correct bits
+template <typename U>
+U inverseModPowerOfTwo(U x) {
+    U inverse = x;
+    for (size_t bits = 3; bits < sizeof(U) * 8; bits *= 2) inverse *= 2 - x * inverse;
+    return inverse;
+}
+
+template <>
+struct CoefficientTraits<int> {
+    using Ring = unsigned;
+    static constexpr bool exactNtt = true;
+    static constexpr bool karatsuba = true;
+    static constexpr bool field = false;
+    static int64_t toInteger(unsigned x) { return int(x); }
+    static unsigned fromInteger(__int128 x) { return unsigned(x); }  // Modulo 2^32
+    static bool invertible(unsigned x) { return x & 1; }
+    static unsigned inverse(unsigned x) { return inverseModPowerOfTwo(x); }
+};
+
+template <>
+struct CoefficientTraits<long long> {
+    using Ring = unsigned long long;
+    static constexpr bool exactNtt = false;
+    static constexpr bool karatsuba = true;
+    static constexpr bool field = false;
+    static bool invertible(Ring x) { return x & 1; }
+    static Ring inverse(Ring x) { return inverseModPowerOfTwo(x); }
+};
+
+template <>
+struct CoefficientTraits<__int128> {
+    using Ring = unsigned __int128;
+    static constexpr bool exactNtt = false;
+    static constexpr bool karatsuba = true;
+    static constexpr bool field = false;
+    static bool invertible(Ring x) { return x & 1; }
+    static Ring inverse(Ring x) { return inverseModPowerOfTwo(x); }
+};
+
+template <>
+struct CoefficientTraits<double> {
+    using Ring = double;
+    static constexpr bool exactNtt = false;
+    static constexpr bool karatsuba = true;
+    static constexpr bool field = false;  // Rounding makes remainders inexact, so no GCD
+    static bool invertible(double x) { return x != 0; }
+    static double inverse(double x) { return 1 / x; }
+};
+
+template <uint32_t P>
+struct CoefficientTraits<ModInt<P>> {
+    using Ring = ModInt<P>;
+    static constexpr bool exactNtt = true;
+    static constexpr bool karatsuba = true;
+    static int64_t toInteger(ModInt<P> x) { return x.value(); }
+    static ModInt<P> fromInteger(__int128 x) { return ModInt<P>(int64_t(x % P)); }
+    static constexpr bool field = true;
+    static bool invertible(ModInt<P> x) { return x != ModInt<P>(0); }
+    static ModInt<P> inverse(ModInt<P> x) { return x.inverse(); }
+};
+
+template <typename T>
+struct CoefficientTraits<Checked<T>> {
+    using Ring = Checked<T>;
+    static constexpr bool exactNtt = false;
+    static constexpr bool karatsuba = false;
+    static constexpr bool field = false;
+    static bool invertible(Checked<T> x) { return x == Checked<T>(1) || x == Checked<T>(-1); }
+    static Checked<T> inverse(Checked<T> x) { return x; }
+};
+
+// Multiplication kernels on dense coefficient arrays (index = exponent), over the
+// coefficient ring T
+
+// Schoolbook product: out (size na + nb - 1, zeroed, not overlapping a or b) += a * b.
+// The inner loop runs in fixed blocks of 8, which compilers vectorize even where
+// the lengths are unknown, such as at the bottom of the Karatsuba recursion.
+template <typename T>
+void multiplySchoolbook(const T* __restrict a, size_t na, const T* __restrict b, size_t nb, T* __restrict out) {
+    for (size_t i = 0; i < na; ++i) {
+        T x = a[i];
+        T* row = out + i;
+        size_t j = 0;
+        for (; j + 8 <= nb; j += 8) {
+            for (size_t k = 0; k < 8; ++k) row[j + k] += x * b[j + k];
+        }
+        for (; j < nb; ++j) row[j] += x * b[j];
+    }
+}
+
+// Scratch space multiplyKaratsuba() needs for length n: each level takes 4 ceil(n/2)
+// entries for its operand sums and middle product, and its three half-size
+// products run one after another in the space beyond that, about 4n in total
+inline size_t karatsubaScratchSize(size_t n, size_t cutoff) {
+    size_t size = 0;
+    for (; n >= max<size_t>(cutoff, 2); n -= n / 2) size += 4 * (n - n / 2);
+    return size;
+}
+
+// Karatsuba product of two arrays of equal length n: three half-size products
+// instead of four, (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 giving the middle terms.
+// Falls back to schoolbook below `cutoff`. out has size 2n - 1 and is zeroed;
+// scratch holds karatsubaScratchSize(n, cutoff) entries, so the recursion itself
+// never allocates.
+template <typename T>
+void multiplyKaratsuba(const T* a, const T* b, size_t n, T* out, size_t cutoff, T* scratch) {
+    if (n < max<size_t>(cutoff, 2)) {
+        multiplySchoolbook(a, n, b, n, out);
+        return;
+    }
+    size_t low = n / 2, high = n - low;
+    T* sumA = scratch;
+    T* sumB = sumA + high;
+    T* middle = sumB + high;  // 2 high - 1 entries
+    T* rest = scratch + 4 * high;
+    for (size_t i = 0; i < high; ++i) {
+        sumA[i] = a[low + i] + (i < low ? a[i] : T(0));
+        sumB[i] = b[low + i] + (i < low ? b[i] : T(0));
+    }
+    fill(middle, middle + 2 * high - 1, T(0));
+    multiplyKaratsuba(a, b, low, out, cutoff, rest);                         // a0 b0 -> out[0, 2 low - 1)
+    multiplyKaratsuba(a + low, b + low, high, out + 2 * low, cutoff, rest);  // a1 b1 -> out[2 low, 2n - 1)
+    multiplyKaratsuba(sumA, sumB, high, middle, cutoff, rest);
+    for (size_t i = 0; i < 2 * low - 1; ++i) middle[i] -= out[i];
+    for (size_t i = 0; i < 2 * high - 1; ++i) middle[i] -= out[2 * low + i];
+    for (size_t i = 0; i < 2 * high - 1; ++i) out[low + i] += middle[i];
+}
+
+// The same with scratch space allocated once for the whole recursion
+template <typename T>
+void multiplyKaratsuba(const T* a, const T* b, size_t n, T* out, size_t cutoff) {
+    vector<T> scratch(karatsubaScratchSize(n, cutoff));
+    multiplyKaratsuba(a, b, n, out, cutoff, scratch.data());
+}
+
+// Number-theoretic transform modulo the prime P = c * 2^k + 1 with primitive root G.
+// Length must be a power of two no larger than 2^k.
+template <uint32_t P, uint32_t G>
+struct Ntt {
+    static uint32_t power(uint64_t x, uint64_t n) {
+        uint64_t result = 1;
+        for (x %= P; n; n >>= 1, x = x * x % P) {
+            if (n & 1) result = result * x % P;
+        }
+        return result;
+    }
+
+    static void transform(vector<uint32_t>& a, bool inverse) {
+        size_t n = a.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {  // Bit-reversal permutation
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) swap(a[i], a[j]);
+        }
+        vector<uint32_t> roots(n / 2 + 1);
+        for (size_t len = 2; len <= n; len <<= 1) {
+            uint64_t step = power(G, (P - 1) / len);
+            if (inverse) step = power(step, P - 2);
+            roots[0] = 1;
+            for (size_t i = 1; i < len / 2; ++i) roots[i] = roots[i - 1] * step % P;
+            for (size_t i = 0; i < n; i += len) {
+                for (size_t j = 0; j < len / 2; ++j) {
+                    uint32_t u = a[i + j];
+                    uint32_t v = uint64_t(a[i + j + len / 2]) * roots[j] % P;
+                    a[i + j] = u + v < P ? u + v : u + v - P;
+                    a[i + j + len / 2] = u >= v ? u - v : u + P - v;
+                }
+            }
+        }
+        if (inverse) {
+            uint64_t scale = power(n, P - 2);
+            for (uint32_t& x : a) x = x * scale % P;
+        }
+    }
+
+    // Cyclic product of a and b (padded to the transform length) modulo P;
+    // toInteger maps each coefficient to a signed integer below 2^31 in magnitude
+    template <typename R, typename ToInteger>
+    static vector<uint32_t> multiply(span<const R> a, span<const R> b, size_t length, ToInteger toInteger) {
+        vector<uint32_t> fa(length, 0), fb(length, 0);
+        for (size_t i = 0; i < a.size(); ++i) fa[i] = (toInteger(a[i]) % P + P) % P;
+        for (size_t i = 0; i < b.size(); ++i) fb[i] = (toInteger(b[i]) % P + P) % P;
+        transform(fa, false);
+        transform(fb, false);
+        for (size_t i = 0; i < length; ++i) fa[i] = uint64_t(fa[i]) * fb[i] % P;
+        transform(fa, true);
+        return fa;
+    }
+};
+
+// Exact product through the NTT modulo three primes, then the Chinese remainder
+// theorem (Garner's form) rebuilds each coefficient. The primes multiply to about
+// 2^86, enough for products of 2^23 coefficients of up to 2^31 in magnitude.
+// The exact coefficients are then mapped back to the ring (modulo 2^32 for int,
+// modulo P for ModInt<P>).
+constexpr size_t nttMaxLength = size_t(1) << 23;  // Largest power of two dividing 998244353 - 1
+
+template <typename T>
+vector<typename CoefficientTraits<T>::Ring> multiplyNtt(span<const typename CoefficientTraits<T>::Ring> a,
+                                                        span<const typename CoefficientTraits<T>::Ring> b) {
+    using Traits = CoefficientTraits<T>;
+    constexpr uint32_t p1 = 998244353, p2 = 167772161, p3 = 469762049;
+    size_t resultSize = a.size() + b.size() - 1;
+    size_t length = bit_ceil(resultSize);
+    vector<uint32_t> r1 = Ntt<p1, 3>::multiply(a, b, length, Traits::toInteger);
+    if constexpr (is_same_v<T, ModInt<p1>>) {  // Already the answer: no need for the other two primes
+        vector<typename Traits::Ring> result(resultSize);
+        for (size_t i = 0; i < resultSize; ++i) result[i] = int64_t(r1[i]);
+        return result;
+    }
+    vector<uint32_t> r2 = Ntt<p2, 3>::multiply(a, b, length, Traits::toInteger);
+    vector<uint32_t> r3 = Ntt<p3, 3>::multiply(a, b, length, Traits::toInteger);
+
+    const uint64_t inv1mod2 = Ntt<p2, 3>::power(p1, p2 - 2);
+    const uint64_t inv12mod3 = Ntt<p3, 3>::power(uint64_t(p1) * p2 % p3, p3 - 2);
+    const __int128 m12 = uint64_t(p1) * p2, m123 = m12 * p3;
+    vector<typename Traits::Ring> result(resultSize);
+    for (size_t i = 0; i < resultSize; ++i) {
+        // x = r1 + p1 t2 + p1 p2 t3 with 0 <= x < p1 p2 p3
+        uint64_t t2 = (r2[i] + p2 - r1[i] % p2) % p2 * inv1mod2 % p2;
+        uint64_t x12 = r1[i] + uint64_t(p1) * t2;  // < p1 p2
+        uint64_t t3 = (r3[i] + p3 - x12 % p3) % p3 * inv12mod3 % p3;
+        __int128 x = x12 + m12 * t3;
+        if (x > m123 / 2) x -= m123;  // The upper half of the range holds the negative values
+        result[i] = Traits::fromInteger(x);
+    }
+    return result;
+}
+
+// Size cutoffs (length of the shorter operand) for choosing a multiplication kernel,
+// and the division and GCD algorithms built on it
+struct MultiplyCutoffs {
+    size_t karatsuba = 32;  // Schoolbook below this
+    size_t ntt = 1024;      // Karatsuba below this, NTT from here on
+    size_t division = 128;  // Long division below this (shorter of quotient and divisor), Newton from here on
+    size_t gcd = 8192;      // Euclid's algorithm below this degree, half-GCD from here on
+    size_t halfGcd = 128;   // Half-GCD recursion switches to plain Euclidean steps below this degree
+    size_t evaluation = 1024;  // Scalar Horner below this degree, subproduct tree from here on (for as many points)
+};
+
+// Single-point evaluation: c[0] + c[1] x + ... + c[n - 1] x^(n - 1) over the ring R
+template <typename R>
+R hornerAt(const R* c, size_t n, R x) {
+    R result = R(0);
+    for (size_t k = n; k-- > 0;) result = result * x + c[k];
+    return result;
+}
+
+// Estrin's scheme: pair up terms as c[2k] + c[2k + 1] x, then pairs of pairs with x^2,
+// and so on with x^4, x^8, ... The dependency chain is log2(n) multiply-adds long
+// instead of Horner's n, which helps when there are too few points to fill the lanes.
+// `scratch` holds one level of partial sums and is reused between points.
+template <typename R>
+R estrinAt(const R* c, size_t n, R x, vector<R>& scratch) {
+    if (n == 0) return R(0);
+    scratch.assign(c, c + n);
+    for (size_t size = n; size > 1; size = (size + 1) / 2, x *= x) {
+        for (size_t k = 0; 2 * k < size; ++k)
+            scratch[k] = 2 * k + 1 < size ? scratch[2 * k] + scratch[2 * k + 1] * x : scratch[2 * k];
+    }
+    return scratch[0];
+}
+
+// Batch Horner kernels for int coefficients, modulo 2^32:
+// out[i] = c[0] + c[1] xs[i] + ... + c[n - 1] xs[i]^(n - 1)
+void hornerScalar(const unsigned* c, size_t n, const unsigned* xs, unsigned* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) out[i] = hornerAt(c, n, xs[i]);
+}
+
+#ifdef HAVE_X86_SIMD
+// Horner's rule in every lane: 8 points per vector, two vectors in flight so the
+// multiply latency of one chain overlaps the other
+__attribute__((target("avx2")))
+void hornerAvx2(const unsigned* c, size_t n, const unsigned* xs, unsigned* out, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i));
+        __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i + 8));
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+        for (size_t k = n; k-- > 0;) {
+            __m256i ck = _mm256_set1_epi32(c[k]);
+            acc0 = _mm256_add_epi32(_mm256_mullo_epi32(acc0, x0), ck);
+            acc1 = _mm256_add_epi32(_mm256_mullo_epi32(acc1, x1), ck);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), acc0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 8), acc1);
+    }
+    hornerScalar(c, n, xs + i, out + i, count - i);
+}
+
+__attribute__((target("avx512f")))
+void hornerAvx512(const unsigned* c, size_t n, const unsigned* xs, unsigned* out, size_t count) {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m512i x0 = _mm512_loadu_si512(xs + i);
+        __m512i x1 = _mm512_loadu_si512(xs + i + 16);
+        __m512i acc0 = _mm512_setzero_si512(), acc1 = _mm512_setzero_si512();
+        for (size_t k = n; k-- > 0;) {
+            __m512i ck = _mm512_set1_epi32(c[k]);
+            acc0 = _mm512_add_epi32(_mm512_mullo_epi32(acc0, x0), ck);
+            acc1 = _mm512_add_epi32(_mm512_mullo_epi32(acc1, x1), ck);
+        }
+        _mm512_storeu_si512(out + i, acc0);
+        _mm512_storeu_si512(out + i + 16, acc1);
+    }
+    hornerAvx2(c, n, xs + i, out + i, count - i);
+}
+#endif
+
+// Pick the widest Horner kernel the CPU supports, once per process
+void hornerMany(const unsigned* c, size_t n, const unsigned* xs, unsigned* out, size_t count) {
+    using Kernel = void (*)(const unsigned*, size_t, const unsigned*, unsigned*, size_t);
+    static const Kernel kernel = [] {
+#ifdef HAVE_X86_SIMD
+        if (__builtin_cpu_supports("avx512f")) return Kernel(hornerAvx512);
+        if (__builtin_cpu_supports("avx2")) return Kernel(hornerAvx2);
+#endif
+        return Kernel(hornerScalar);
+    }();
+    kernel(c, n, xs, out, count);
+}
+
+enum class EvalScheme {
+    Horner,          // SIMD lanes, best for large batches
+    Estrin,          // Short dependency chain, for a handful of points
+    SubproductTree,  // Remainder tree on fast division, for high degrees and as many points
+};
+
+// Array that keeps up to N elements inside the object and only goes to the heap
+// beyond that, so low-degree polynomials cost no allocation at all. Elements must
+// be trivially copyable; grown storage doubles like std::vector.
+template <typename T, size_t N>
+class SmallVec {
+    static_assert(is_trivially_copyable_v<T>, "SmallVec copies elements as raw memory");
 
 public:
-    // Constructor to initialize a polynomial of given degree
-    Polynomial(int degree) {
-        coeff.resize(degree + 1, 0);  // Initialize all coefficients to 0
+    static constexpr size_t inlineCapacity = N;
+
+    SmallVec() = default;
+    SmallVec(const SmallVec& other) { assign(other.begin(), other.end()); }
+    SmallVec(SmallVec&& other) noexcept { steal(other); }
+    ~SmallVec() { release(); }
+
+    SmallVec& operator=(const SmallVec& other) {
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+    SmallVec& operator=(SmallVec&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T* data() { return first; }
+    const T* data() const { return first; }
+    T* begin() { return first; }
+    T* end() { return first + count; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+    T& operator[](size_t i) { return first[i]; }
+    const T& operator[](size_t i) const { return first[i]; }
+    T& back() { return first[count - 1]; }
+    const T& back() const { return first[count - 1]; }
+    void pop_back() { --count; }
+    void clear() { count = 0; }
+
+    void reserve(size_t n) {
+        if (n <= capacity) return;
+        T* grown = new T[n];
+        copy(first, first + count, grown);
+        release();
+        first = grown;
+        capacity = n;
+    }
+
+    void resize(size_t n, T value = T()) {
+        if (n > capacity) reserve(max<size_t>(n, 2 * capacity));
+        if (n > count) fill(first + count, first + n, value);
+        count = n;
+    }
+
+    void assign(size_t n, T value) {
+        count = 0;
+        resize(n, value);
+    }
+
+    void assign(const T* from, const T* to) {
+        count = 0;
+        reserve(to - from);
+        copy(from, to, first);
+        count = to - from;
+    }
+
+private:
+    T* first = local;
+    uint32_t count = 0;
+    uint32_t capacity = N;
+    T local[N];
+
+    void release() {
+        if (first != local) delete[] first;
+        first = local;
+        capacity = N;
+    }
+
+    // Take other's elements, leaving it empty: a heap buffer changes hands, inline ones are copied
+    void steal(SmallVec& other) {
+        if (other.first == other.local) {
+            copy(other.begin(), other.end(), local);
+        } else {
+            first = other.first;
+            capacity = other.capacity;
+            other.first = other.local;
+            other.capacity = N;
+        }
+        count = other.count;
+        other.count = 0;
     }
+};
+
+// Polynomial with coefficients of type T: int (arithmetic modulo 2^32), long long,
+// __int128, double, ModInt<P> or Checked<T>
+template <typename T = int>
+class BasicPolynomial {
+private:
+    using Traits = CoefficientTraits<T>;
+    using Ring = typename Traits::Ring;
+
+    // One nonzero term of the sparse form: coefficient * x^exponent
+    struct Term {
+        int exponent;
+        Ring coefficient;
+    };
+
+    // Coefficients live in one of two forms, chosen by fill ratio (nonzero terms per
+    // exponent up to the degree): dense, indexed by exponent, or sparse, as a sorted
+    // list of nonzero terms. The dense form is used once it takes no more memory than
+    // the term list (from half full upward for int), so x^1000000 + 1 stays two terms,
+    // and always below degree 8, where the array fits inside the object.
+    //
+    // Both forms are normalized after every operation: the dense array never ends in
+    // a zero and the term list holds no zero terms, so the degree is simply the last
+    // index or exponent, and nothing ever scans past the leading coefficient.
+    using Coefficients = SmallVec<Ring, 8>;
+    Coefficients coeff;   // Dense form: array to store coefficients
+    vector<Term> terms;   // Sparse form: nonzero terms, ascending exponents
+    bool dense = true;
+    int maxDegree;        // Highest exponent setCoefficient() accepts
+    size_t nonzeros = 0;  // Nonzero coefficients, in either form
+
+    // x^n by repeated squaring: O(log n) multiplications
+    static Ring power(Ring x, unsigned n) {
+        Ring result = Ring(1);
+        for (; n; n >>= 1, x *= x) {
+            if (n & 1) result *= x;
+        }
+        return result;
+    }
+
+    static bool preferDense(size_t nonzeros, size_t slots) {
+        return slots <= Coefficients::inlineCapacity || nonzeros * sizeof(Term) >= slots * sizeof(Ring);
+    }
+
+    void toDense() {
+        coeff.assign(terms.empty() ? 0 : terms.back().exponent + 1, Ring(0));
+        for (const Term& t : terms) coeff[t.exponent] = t.coefficient;
+        terms = vector<Term>();
+        dense = true;
+    }
+
+    void toSparse() {
+        terms.clear();
+        terms.reserve(nonzeros);
+        for (size_t i = 0; i < coeff.size(); ++i) {
+            if (coeff[i] != Ring(0)) terms.push_back({int(i), coeff[i]});
+        }
+        coeff = Coefficients();
+        dense = false;
+    }
+
+    // Exponents up to the degree: the dense array length, or the last exponent + 1
+    size_t slotCount() const { return degree() + 1; }
+
+    // Drop zero leading coefficients from a dense array
+    template <typename Storage>
+    static void trim(Storage& a) {
+        while (!a.empty() && a.back() == Ring(0)) a.pop_back();
+    }
+
+    // Switch to whichever form is smaller for the current fill ratio
+    void rebalance() {
+        size_t slots = slotCount();
+        if (dense && !preferDense(nonzeros, slots)) toSparse();
+        else if (!dense && slots && preferDense(nonzeros, slots)) toDense();
+    }
+
+    size_t countNonzeros() const { return coeff.size() - count(coeff.begin(), coeff.end(), Ring(0)); }
+
+    // Before adding `other`, switch to the form the sum should have. The check comes
+    // first so that a dense array is never grown to reach a far-off sparse term
+    // (x^100000000 + 1 added to a cubic), only to be turned into terms afterwards.
+    void prepareToAdd(const BasicPolynomial& other) {
+        bool sumDense = preferDense(nonzeros + other.nonzeros, max(slotCount(), other.slotCount()));
+        if (dense && !other.dense && other.slotCount() > coeff.size() && !sumDense) toSparse();
+        else if (!dense && other.dense && sumDense) toDense();
+    }
+
+    // this (+ or -)= other in place, in whatever form this already has, without
+    // rebalancing. A dense polynomial grows its array only when `other` reaches past
+    // it; a sparse one merges the two term lists from the back into its own vector,
+    // so nothing is allocated when the capacity is already there.
+    template <bool subtract>
+    void accumulate(const BasicPolynomial& other) {
+        if (this == &other) {  // The merge below would read terms it has already overwritten
+            BasicPolynomial copy(other);
+            accumulate<subtract>(copy);
+            return;
+        }
+        auto combine = [](Ring x, Ring y) { return subtract ? x - y : x + y; };
+        maxDegree = max(maxDegree, other.maxDegree);
+        if (dense) {
+            if (coeff.size() < other.slotCount()) coeff.resize(other.slotCount(), Ring(0));
+            auto add = [&](size_t i, Ring y) {
+                Ring sum = combine(coeff[i], y);
+                nonzeros += (sum != Ring(0)) - (coeff[i] != Ring(0));
+                coeff[i] = sum;
+            };
+            if (other.dense) {
+                for (size_t i = 0; i < other.coeff.size(); ++i) add(i, other.coeff[i]);
+            } else {
+                for (const Term& t : other.terms) add(t.exponent, t.coefficient);
+            }
+            trim(coeff);
+            return;
+        }
+        size_t cursor = other.dense ? other.coeff.size() : other.terms.size();
+        auto last = [&] {  // Other's highest term not merged yet, in either form
+            if (!other.dense) return other.terms[cursor - 1];
+            while (other.coeff[cursor - 1] == Ring(0)) --cursor;
+            return Term{int(cursor - 1), other.coeff[cursor - 1]};
+        };
+        size_t i = terms.size(), j = other.nonzeros, k = i + j;
+        terms.resize(k);
+        while (j > 0) {
+            Term t = last();
+            if (i > 0 && terms[i - 1].exponent > t.exponent) {
+                terms[--k] = terms[--i];
+            } else {
+                Ring mine = Ring(0);
+                if (i > 0 && terms[i - 1].exponent == t.exponent) mine = terms[--i].coefficient;
+                terms[--k] = {t.exponent, combine(mine, t.coefficient)};
+                --j, --cursor;
+            }
+        }
+        // terms[0, i) were already in place; close the gap up to k, dropping cancelled terms
+        size_t end = i;
+        for (size_t r = k; r < terms.size(); ++r) {
+            if (terms[r].coefficient != Ring(0)) terms[end++] = terms[r];
+        }
+        terms.resize(end);
+        nonzeros = end;
+    }
+
+    // The coefficient array: the dense form itself, or `scratch` expanded from the terms
+    span<const Ring> denseArray(vector<Ring>& scratch) const {
+        if (dense) return {coeff.data(), coeff.size()};
+        scratch.assign(degree() + 1, Ring(0));
+        for (const Term& t : terms) scratch[t.exponent] = t.coefficient;
+        return scratch;
+    }
+
+    // The nonzero terms in ascending order: the sparse list itself, or `scratch` filled from the dense form
+    const vector<Term>& termList(vector<Term>& scratch) const {
+        if (!dense) return terms;
+        scratch.clear();
+        for (size_t i = 0; i < coeff.size(); ++i) {
+            if (coeff[i] != Ring(0)) scratch.push_back({int(i), coeff[i]});
+        }
+        return scratch;
+    }
+
+    // Division and GCD work on bare coefficient arrays (index = exponent), kept
+    // trimmed so that the last entry is the nonzero leading coefficient
+    using Array = vector<Ring>;
+    using Matrix = array<Array, 4>;  // 2x2 polynomial matrix {m00, m01, m10, m11}, acting on a pair (a, b)
+
+    Array toArray() const {
+        Array a;
+        if (dense) a.assign(coeff.begin(), coeff.end());
+        else denseArray(a);
+        trim(a);
+        return a;
+    }
+
+    static BasicPolynomial fromArray(Array a, int maxDegree) {
+        BasicPolynomial result(max(maxDegree, int(a.size()) - 1));
+        result.coeff.assign(a.data(), a.data() + a.size());
+        result.nonzeros = result.countNonzeros();
+        result.rebalance();
+        return result;
+    }
+
+    static Array multiplyArrays(const Array& a, const Array& b) {
+        if (a.empty() || b.empty()) return {};
+        Array product = multiplyDense(a, b);
+        trim(product);
+        return product;
+    }
+
+    static Array combineArrays(Array a, const Array& b, bool subtract) {
+        if (a.size() < b.size()) a.resize(b.size(), Ring(0));
+        for (size_t i = 0; i < b.size(); ++i) a[i] = subtract ? a[i] - b[i] : a[i] + b[i];
+        trim(a);
+        return a;
+    }
+
+    static Array monic(Array a) {
+        if (a.empty()) return a;
+        Ring leadInverse = Traits::inverse(a.back());
+        for (Ring& c : a) c *= leadInverse;
+        return a;
+    }
+
+    // First n coefficients of the power series 1 / f, for f[0] invertible. Newton's
+    // iteration g <- g (2 - f g) doubles the number of correct terms per step, so the
+    // whole series costs a few multiplications of length n.
+    static Array seriesInverse(span<const Ring> f, size_t n) {
+        if (n == 0) return {};
+        Array g{Traits::inverse(f[0])};
+        while (g.size() < n) {
+            size_t length = min(2 * g.size(), n);
+            Array correction = multiplyDense(f.first(min(f.size(), length)), g);
+            correction.resize(length, Ring(0));
+            for (Ring& c : correction) c = -c;
+            correction[0] += Ring(2);
+            g = multiplyDense(g, correction);
+            g.resize(length);
+        }
+        return g;
+    }
+
+    // Schoolbook long division: O(deg quotient * deg divisor)
+    static void longDivide(const Array& a, const Array& b, Array& quotient, Array& remainder) {
+        remainder = a;
+        if (a.size() < b.size()) {
+            quotient.clear();
+            return;
+        }
+        quotient.assign(a.size() - b.size() + 1, Ring(0));
+        Ring leadInverse = Traits::inverse(b.back());
+        for (size_t i = quotient.size(); i-- > 0;) {
+            Ring q = remainder[i + b.size() - 1] * leadInverse;
+            quotient[i] = q;
+            if (q == Ring(0)) continue;
+            for (size_t j = 0; j < b.size(); ++j) remainder[i + j] -= q * b[j];
+        }
+        remainder.resize(b.size() - 1);
+        trim(quotient);
+        trim(remainder);
+    }
+
+    // Division through the reversed polynomials: with n = deg a and m = deg b,
+    // rev(a) = rev(q) rev(b) mod x^(n - m + 1), so rev(q) is rev(a) times the series
+    // inverse of rev(b). `reciprocal` caches that inverse between divisions by the
+    // same b; a cached prefix is reused whenever it is long enough.
+    static void divideArrays(const Array& a, const Array& b, Array& reciprocal, Array& quotient, Array& remainder) {
+        if (a.size() < b.size()) {
+            quotient.clear();
+            remainder = a;
+            return;
+        }
+        size_t length = a.size() - b.size() + 1;
+        if (min(length, b.size()) < cutoffs.division) {
+            longDivide(a, b, quotient, remainder);
+            return;
+        }
+        if (reciprocal.size() < length) reciprocal = seriesInverse(Array(b.rbegin(), b.rend()), length);
+        quotient = multiplyDense(Array(a.rbegin(), a.rbegin() + length), span<const Ring>(reciprocal).first(length));
+        quotient.resize(length);
+        reverse(quotient.begin(), quotient.end());
+        trim(quotient);
+        Array product = multiplyArrays(b, quotient);  // Agrees with a from x^(deg b) up
+        remainder.assign(a.begin(), a.begin() + b.size() - 1);
+        for (size_t i = 0; i < remainder.size() && i < product.size(); ++i) remainder[i] -= product[i];
+        trim(remainder);
+    }
+
+    // Subproduct tree over xs: tree[node] = prod (x - xs[i]) over the node's points,
+    // with children 2 node + 1 and 2 node + 2. Leaves of up to 32 points are multiplied
+    // out one linear factor at a time. Every product is monic, so any ring divides by it.
+    static constexpr size_t treeLeaf = 32;
+    static void buildTree(span<const T> xs, vector<Array>& tree, size_t node = 0) {
+        if (node >= tree.size()) tree.resize(2 * node + 1);
+        if (xs.size() <= treeLeaf) {
+            Array f{Ring(1)};
+            for (T x : xs) {
+                f.push_back(Ring(0));
+                for (size_t j = f.size() - 1; j > 0; --j) f[j] = f[j - 1] - Ring(x) * f[j];
+                f[0] = -(Ring(x) * f[0]);
+            }
+            tree[node] = move(f);
+            return;
+        }
+        size_t half = xs.size() / 2;
+        buildTree(xs.first(half), tree, 2 * node + 1);
+        buildTree(xs.subspan(half), tree, 2 * node + 2);
+        tree[node] = multiplyArrays(tree[2 * node + 1], tree[2 * node + 2]);
+    }
+
+    // Remainder tree: p mod tree[node] agrees with p on the node's points, so reducing
+    // down the tree leaves a polynomial of degree < 32 to evaluate at each leaf
+    static void reduceTree(const Array& p, span<const T> xs, span<T> out, const vector<Array>& tree, size_t node = 0) {
+        Array quotient, remainder, reciprocal;
+        divideArrays(p, tree[node], reciprocal, quotient, remainder);
+        if (xs.size() <= treeLeaf) {
+            for (size_t i = 0; i < xs.size(); ++i) out[i] = T(hornerAt(remainder.data(), remainder.size(), Ring(xs[i])));
+            return;
+        }
+        size_t half = xs.size() / 2;
+        reduceTree(remainder, xs.first(half), out.first(half), tree, 2 * node + 1);
+        reduceTree(remainder, xs.subspan(half), out.subspan(half), tree, 2 * node + 2);
+    }
+
+    static Matrix identity() { return {Array{Ring(1)}, Array{}, Array{}, Array{Ring(1)}}; }
+
+    static Matrix multiplyMatrices(const Matrix& x, const Matrix& y) {
+        auto entry = [&](int i, int j) {
+            return combineArrays(multiplyArrays(x[2 * i], y[j]), multiplyArrays(x[2 * i + 1], y[2 + j]), false);
+        };
+        return {entry(0, 0), entry(0, 1), entry(1, 0), entry(1, 1)};
+    }
+
+    // (a, b) <- m (a, b)
+    static void apply(const Matrix& m, Array& a, Array& b) {
+        Array first = combineArrays(multiplyArrays(m[0], a), multiplyArrays(m[1], b), false);
+        b = combineArrays(multiplyArrays(m[2], a), multiplyArrays(m[3], b), false);
+        a = move(first);
+    }
+
+    // One step of Euclid's algorithm, (a, b) <- (b, a mod b), recorded in m as well
+    static void euclidStep(Array& a, Array& b, Matrix& m) {
+        Array quotient, remainder, reciprocal;
+        divideArrays(a, b, reciprocal, quotient, remainder);
+        a = move(b);
+        b = move(remainder);
+        Array row2 = combineArrays(m[0], multiplyArrays(quotient, m[2]), true);
+        Array row3 = combineArrays(m[1], multiplyArrays(quotient, m[3]), true);
+        m = {move(m[2]), move(m[3]), move(row2), move(row3)};
+    }
+
+    // Half-GCD: the product of the Euclidean steps that take (a, b), deg a > deg b,
+    // until deg b drops below half of deg a. The quotients in that first half depend
+    // only on the top coefficients, so they come from a recursion on a / x^k and
+    // b / x^k, one explicit step, and a second recursion on what remains.
+    static Matrix halfGcd(Array a, Array b) {
+        size_t k = a.size() / 2;
+        Matrix m = identity();
+        if (b.size() <= k) return m;
+        if (a.size() <= cutoffs.halfGcd) {
+            while (b.size() > k) euclidStep(a, b, m);
+            return m;
+        }
+        m = halfGcd(Array(a.begin() + k, a.end()), Array(b.begin() + k, b.end()));
+        apply(m, a, b);
+        if (b.size() <= k) return m;
+        euclidStep(a, b, m);
+        if (b.size() <= k) return m;
+        size_t shift = 2 * k > a.size() - 1 ? 2 * k - (a.size() - 1) : 0;
+        return multiplyMatrices(halfGcd(Array(a.begin() + shift, a.end()), Array(b.begin() + shift, b.end())), m);
+    }
+
+public:
+    static inline MultiplyCutoffs cutoffs;  // Tunable, e.g. from benchmarkMultiplyCutoffs()
+
+    // Product of two dense coefficient arrays, with the kernel chosen by the shorter length
+    static vector<Ring> multiplyDense(span<const Ring> a, span<const Ring> b) {
+        if (a.size() > b.size()) swap(a, b);
+        size_t resultSize = a.size() + b.size() - 1;
+        if constexpr (Traits::exactNtt) {
+            if (a.size() >= cutoffs.ntt && resultSize <= nttMaxLength) return multiplyNtt<T>(a, b);
+        }
+        vector<Ring> result(resultSize, Ring(0));
+        if (!Traits::karatsuba || a.size() < cutoffs.karatsuba) {
+            multiplySchoolbook(a.data(), a.size(), b.data(), b.size(), result.data());
+            return result;
+        }
+        // Karatsuba needs equal lengths, so b is cut into blocks as long as a
+        size_t n = a.size();
+        vector<Ring> block(n), partial(2 * n - 1), scratch(karatsubaScratchSize(n, cutoffs.karatsuba));
+        for (size_t start = 0; start < b.size(); start += n) {
+            size_t length = min(n, b.size() - start);
+            fill(copy_n(b.begin() + start, length, block.begin()), block.end(), Ring(0));
+            fill(partial.begin(), partial.end(), Ring(0));
+            multiplyKaratsuba(a.data(), block.data(), n, partial.data(), cutoffs.karatsuba, scratch.data());
+            for (size_t i = 0; i < partial.size() && start + i < resultSize; ++i) result[start + i] += partial[i];
+        }
+        return result;
+    }
+
+    // Constructor for a polynomial of up to the given degree. Nothing is allocated
+    // up front: the polynomial starts as an empty dense array, stored inline.
+    BasicPolynomial(int degree) : maxDegree(degree) {}
 
     // Function to set a coefficient for a specific term
-    void setCoefficient(int exponent, int value) {
-        if (exponent < coeff.size()) {
-            coeff[exponent] = value;
+    void setCoefficient(int exponent, T value) {
+        if (exponent < 0 || exponent > maxDegree) return;
+        Ring c = Ring(value);
+        bool nonzero = c != Ring(0);
+        if (dense && size_t(exponent) >= coeff.size()) {
+            if (!nonzero) return;
+            if (!preferDense(nonzeros + 1, exponent + 1)) toSparse();  // Growing the array would leave it mostly empty
+            else coeff.resize(exponent + 1, Ring(0));
+        }
+        if (dense) {
+            nonzeros += nonzero - (coeff[exponent] != Ring(0));
+            coeff[exponent] = c;
+            trim(coeff);
+        } else {
+            auto it = lower_bound(terms.begin(), terms.end(), exponent,
+                                  [](const Term& t, int e) { return t.exponent < e; });
+            if (it != terms.end() && it->exponent == exponent) {
+                if (nonzero) it->coefficient = c;
+                else terms.erase(it), --nonzeros;
+            } else if (nonzero) {
+                terms.insert(it, {exponent, c});
+                ++nonzeros;
+            }
         }
+        rebalance();
     }
 
+    // Highest exponent with a nonzero coefficient, or -1 for the zero polynomial: O(1),
+    // since neither form keeps zeros past the leading term
+    int degree() const {
+        if (dense) return int(coeff.size()) - 1;
+        return terms.empty() ? -1 : terms.back().exponent;
+    }
+
+    size_t termCount() const { return nonzeros; }
+    bool isSparse() const { return !dense; }
+
     // Function to display the polynomial
     void display() const {
         bool isFirst = true;  // To format the output properly
-        for (int i = coeff.size() - 1; i >= 0; --i) {
-            if (coeff[i] != 0) {
-                if (!isFirst) cout << " + ";
-                cout << coeff[i] << "x^" << i;
-                isFirst = false;
+        auto print = [&](int exponent, Ring c) {
+            if (!isFirst) cout << " + ";
+            cout << T(c) << "x^" << exponent;
+            isFirst = false;
+        };
+        if (dense) {
+            for (size_t i = coeff.size(); i-- > 0;) {
+                if (coeff[i] != Ring(0)) print(i, coeff[i]);
             }
+        } else {
+            for (auto it = terms.rbegin(); it != terms.rend(); ++it) print(it->exponent, it->coefficient);
         }
         cout << endl;
     }
 
-    // Polynomial addition
-    Polynomial operator+(const Polynomial &other) const {
-        int maxDegree = max(coeff.size(), other.coeff.size());
-        Polynomial result(maxDegree - 1);
+    // Polynomial addition: term by term when both are dense, otherwise a linear
+    // merge of the two sorted term lists, so the cost follows the number of terms
+    BasicPolynomial operator+(const BasicPolynomial &other) const {
+        BasicPolynomial result(max(maxDegree, other.maxDegree));
+        if (dense && other.dense) {
+            const Coefficients& longer = coeff.size() >= other.coeff.size() ? coeff : other.coeff;
+            const Coefficients& shorter = coeff.size() >= other.coeff.size() ? other.coeff : coeff;
+            result.coeff = longer;
+            for (size_t i = 0; i < shorter.size(); ++i) result.coeff[i] += shorter[i];
+            trim(result.coeff);
+            result.nonzeros = result.countNonzeros();
+        } else {
+            result.dense = false;
+            vector<Term> scratch1, scratch2;
+            const vector<Term>& a = termList(scratch1);
+            const vector<Term>& b = other.termList(scratch2);
+            result.terms.reserve(a.size() + b.size());
+            size_t i = 0, j = 0;
+            while (i < a.size() || j < b.size()) {
+                if (j == b.size() || (i < a.size() && a[i].exponent < b[j].exponent)) {
+                    result.terms.push_back(a[i++]);
+                } else if (i == a.size() || b[j].exponent < a[i].exponent) {
+                    result.terms.push_back(b[j++]);
+                } else {
+                    Ring sum = a[i++].coefficient + b[j++].coefficient;
+                    if (sum != Ring(0)) result.terms.push_back({a[i - 1].exponent, sum});  // Cancelled terms are dropped
+                }
+            }
+            result.nonzeros = result.terms.size();
+        }
+        result.rebalance();
+        return result;
+    }
 
-        for (int i = 0; i < maxDegree; ++i) {
-            int c1 = (i < coeff.size()) ? coeff[i] : 0;
-            int c2 = (i < other.coeff.size()) ? other.coeff[i] : 0;
-            result.setCoefficient(i, c1 + c2);
+    BasicPolynomial operator-(const BasicPolynomial &other) const {
+        BasicPolynomial result(*this);
+        result -= other;
+        return result;
+    }
+
+    BasicPolynomial& operator+=(const BasicPolynomial &other) {
+        prepareToAdd(other);
+        accumulate<false>(other);
+        rebalance();
+        return *this;
+    }
+
+    BasicPolynomial& operator-=(const BasicPolynomial &other) {
+        prepareToAdd(other);
+        accumulate<true>(other);
+        rebalance();
+        return *this;
+    }
+
+    BasicPolynomial& operator*=(const BasicPolynomial &other) { return *this = *this * other; }
+
+    // A temporary operand is about to die, so its storage becomes the result:
+    // p1 + p2 + p3 + p4 allocates for p1 + p2 and then adds p3 and p4 in place
+    friend BasicPolynomial operator+(BasicPolynomial &&a, const BasicPolynomial &b) { return move(a += b); }
+    friend BasicPolynomial operator+(const BasicPolynomial &a, BasicPolynomial &&b) { return move(b += a); }
+    friend BasicPolynomial operator+(BasicPolynomial &&a, BasicPolynomial &&b) { return move(a += b); }
+    friend BasicPolynomial operator-(BasicPolynomial &&a, const BasicPolynomial &b) { return move(a -= b); }
+
+    // Sum of any number of polynomials with a single allocation: the form is picked
+    // once from the total term count and the highest degree, the result is sized for
+    // all operands (dense array or term list), then each is added in place
+    template <typename... Polynomials>
+        requires(sizeof...(Polynomials) > 0 && (is_same_v<Polynomials, BasicPolynomial> && ...))
+    static BasicPolynomial sum(const Polynomials&... operands) {
+        BasicPolynomial result(max({operands.maxDegree...}));
+        size_t slots = max({operands.slotCount()...});
+        size_t total = (operands.nonzeros + ...);
+        if (preferDense(total, slots)) {
+            result.coeff.reserve(slots);
+        } else {
+            result.terms.reserve(total);
+            result.dense = false;
         }
+        (result.template accumulate<false>(operands), ...);
+        result.rebalance();
         return result;
     }
 
-    // Polynomial evaluation at a specific value of x
-    int evaluate(int x) const {
-        int result = 0;
-        int power = 1;  // Tracks powers of x (x^0 = 1 initially)
-        for (int i = 0; i < coeff.size(); ++i) {
-            result += coeff[i] * power;
-            power *= x;  // Increment power of x for next term
+    // Polynomial multiplication. When an operand is sparse and the term products are
+    // few, terms are multiplied pairwise and equal exponents combined; otherwise the
+    // coefficient arrays go to the schoolbook, Karatsuba or NTT kernel by size.
+    BasicPolynomial operator*(const BasicPolynomial &other) const {
+        BasicPolynomial result(int(min<int64_t>(INT_MAX, int64_t(maxDegree) + other.maxDegree)));
+        if (nonzeros == 0 || other.nonzeros == 0) return result;
+        int64_t slots = int64_t(degree()) + other.degree() + 1;
+        if (dense && other.dense && size_t(slots) <= Coefficients::inlineCapacity) {
+            // Small enough to stay inline: schoolbook straight into the result, no heap
+            result.coeff.assign(slots, Ring(0));
+            multiplySchoolbook(coeff.data(), coeff.size(), other.coeff.data(), other.coeff.size(), result.coeff.data());
+            trim(result.coeff);
+            result.nonzeros = result.countNonzeros();
+        } else if ((!dense || !other.dense) && uint64_t(nonzeros) * other.nonzeros <= uint64_t(slots) * 16) {
+            result.dense = false;
+            vector<Term> scratch1, scratch2;
+            const vector<Term>& a = termList(scratch1);
+            const vector<Term>& b = other.termList(scratch2);
+            vector<Term> products;
+            products.reserve(a.size() * b.size());
+            for (const Term& x : a) {
+                for (const Term& y : b) products.push_back({x.exponent + y.exponent, x.coefficient * y.coefficient});
+            }
+            sort(products.begin(), products.end(), [](const Term& x, const Term& y) { return x.exponent < y.exponent; });
+            for (size_t i = 0; i < products.size();) {
+                Ring sum = Ring(0);
+                int exponent = products[i].exponent;
+                for (; i < products.size() && products[i].exponent == exponent; ++i) sum += products[i].coefficient;
+                if (sum != Ring(0)) result.terms.push_back({exponent, sum});
+            }
+            result.nonzeros = result.terms.size();
+        } else {
+            vector<Ring> scratch1, scratch2;
+            vector<Ring> product = multiplyDense(denseArray(scratch1), other.denseArray(scratch2));
+            trim(product);
+            result.coeff.assign(product.data(), product.data() + product.size());
+            result.nonzeros = result.countNonzeros();
         }
+        result.rebalance();
         return result;
     }
+
+    // Polynomial evaluation at a specific value of x. Dense polynomials use Horner's
+    // rule; sparse ones raise x to each gap between exponents by squaring, so
+    // x^1000000 + 1 takes about 20 multiplications instead of a million.
+    T evaluate(T x) const {
+        if (dense) return T(hornerAt(coeff.data(), coeff.size(), Ring(x)));
+        Ring result = Ring(0);
+        Ring powerOfX = Ring(1);  // Tracks x^exponent of the previous term
+        int previous = 0;
+        for (const Term& t : terms) {
+            powerOfX *= power(Ring(x), t.exponent - previous);
+            previous = t.exponent;
+            result += t.coefficient * powerOfX;
+        }
+        return T(result);
+    }
+
+    // Evaluate at many points at once: out[i] = P(xs[i]). Dense polynomials run the
+    // chosen scheme over the whole batch (Horner in AVX-512 / AVX2 lanes for int
+    // coefficients where the CPU has them); sparse ones evaluate point by point.
+    // Scalar Horner switches to the subproduct tree, O(M(m) log^2 m) for m points
+    // instead of O(deg P * m), once the degree passes cutoffs.evaluation with at least
+    // as many points and multiplication is NTT-fast. int coefficients stay on Horner:
+    // its SIMD lanes beat the tree up to about 2^18 points. Large batches are split
+    // into contiguous ranges across threads, each with its own tree.
+    void evaluateMany(span<const T> xs, span<T> out, EvalScheme scheme = EvalScheme::Horner,
+                      unsigned threads = thread::hardware_concurrency()) const {
+        size_t count = min(xs.size(), out.size());
+        size_t work = count * max<size_t>(dense ? coeff.size() : nonzeros, 1);
+        unsigned workers = max<uint64_t>(1, min<uint64_t>(threads, work / (1 << 18)));
+        if constexpr (Traits::exactNtt && !is_same_v<T, int>) {
+            if (scheme == EvalScheme::Horner && dense && coeff.size() > cutoffs.evaluation && count / workers >= coeff.size())
+                scheme = EvalScheme::SubproductTree;
+        }
+        Array p = (scheme == EvalScheme::SubproductTree) ? toArray() : Array();
+        auto range = [&](size_t begin, size_t end) {
+            if (scheme == EvalScheme::SubproductTree) {
+                if (begin == end) return;
+                vector<Array> tree;
+                buildTree(xs.subspan(begin, end - begin), tree);
+                reduceTree(p, xs.subspan(begin, end - begin), out.subspan(begin, end - begin), tree);
+            } else if (!dense) {
+                for (size_t i = begin; i < end; ++i) out[i] = evaluate(xs[i]);
+            } else if (scheme == EvalScheme::Estrin) {
+                vector<Ring> scratch;
+                for (size_t i = begin; i < end; ++i) out[i] = T(estrinAt(coeff.data(), coeff.size(), Ring(xs[i]), scratch));
+            } else if constexpr (is_same_v<T, int>) {
+                // int and unsigned may alias, so the lanes read and write the int arrays in place
+                hornerMany(coeff.data(), coeff.size(), reinterpret_cast<const unsigned*>(xs.data()) + begin,
+                           reinterpret_cast<unsigned*>(out.data()) + begin, end - begin);
+            } else {
+                for (size_t i = begin; i < end; ++i) out[i] = T(hornerAt(coeff.data(), coeff.size(), Ring(xs[i])));
+            }
+        };
+        vector<thread> pool;
+        for (unsigned id = 1; id < workers; ++id) pool.emplace_back(range, count * id / workers, count * (id + 1) / workers);
+        range(0, count / workers);
+        for (auto& t : pool) t.join();
+    }
+
+    // Quotient and remainder: *this = quotient * divisor + remainder with deg remainder
+    // < deg divisor. Long quotients use a Newton-iteration reciprocal of the divisor,
+    // so the cost is a few multiplications instead of long division's
+    // O(deg quotient * deg divisor). Returns false if the divisor is zero or its
+    // leading coefficient has no inverse (an even one, for int coefficients).
+    bool divide(const BasicPolynomial &divisor, BasicPolynomial &quotient, BasicPolynomial &remainder) const {
+        Array b = divisor.toArray();
+        if (b.empty() || !Traits::invertible(b.back())) return false;
+        Array q, r, reciprocal;
+        divideArrays(toArray(), b, reciprocal, q, r);
+        quotient = fromArray(move(q), maxDegree);
+        remainder = fromArray(move(r), divisor.maxDegree);
+        return true;
+    }
+
+    // Reference version of divide(): schoolbook long division
+    bool divideNaive(const BasicPolynomial &divisor, BasicPolynomial &quotient, BasicPolynomial &remainder) const {
+        Array b = divisor.toArray();
+        if (b.empty() || !Traits::invertible(b.back())) return false;
+        Array q, r;
+        longDivide(toArray(), b, q, r);
+        quotient = fromArray(move(q), maxDegree);
+        remainder = fromArray(move(r), divisor.maxDegree);
+        return true;
+    }
+
+    // Monic greatest common divisor (zero if both are zero). Each round applies a
+    // half-GCD matrix that halves the degrees, for O(M(n) log n) in total with M(n)
+    // the cost of a multiplication, instead of the O(n^2) of Euclid's algorithm.
+    static BasicPolynomial gcd(const BasicPolynomial &x, const BasicPolynomial &y) requires Traits::field {
+        Array a = x.toArray(), b = y.toArray();
+        Array quotient, remainder;
+        while (!b.empty()) {
+            Array reciprocal;  // The divisor changes every round
+            divideArrays(a, b, reciprocal, quotient, remainder);
+            a = move(b);
+            b = move(remainder);
+            if (a.size() > cutoffs.gcd) apply(halfGcd(a, b), a, b);
+        }
+        return fromArray(monic(move(a)), max(x.maxDegree, y.maxDegree));
+    }
+
+    // Reference check for the half-GCD step on x and y (deg y < deg x): the pair it
+    // reduces them to must be the one Euclid's algorithm with long division reaches
+    // when the second polynomial first drops below half the length of x. gcd()
+    // stays correct even with a wrong reduction matrix, so this is what catches one.
+    static bool halfGcdMatchesEuclid(const BasicPolynomial &x, const BasicPolynomial &y) requires Traits::field {
+        Array a = x.toArray(), b = y.toArray();
+        if (b.size() >= a.size()) return false;
+        size_t k = a.size() / 2;
+        Array fastA = a, fastB = b, quotient, remainder;
+        apply(halfGcd(a, b), fastA, fastB);
+        while (b.size() > k) {
+            longDivide(a, b, quotient, remainder);
+            a = move(b);
+            b = move(remainder);
+        }
+        return fastA == a && fastB == b;
+    }
+
+    // Reference version of gcd(): Euclid's algorithm with long division
+    static BasicPolynomial gcdNaive(const BasicPolynomial &x, const BasicPolynomial &y) requires Traits::field {
+        Array a = x.toArray(), b = y.toArray();
+        Array quotient, remainder;
+        while (!b.empty()) {
+            longDivide(a, b, quotient, remainder);
+            a = move(b);
+            b = move(remainder);
+        }
+        return fromArray(monic(move(a)), max(x.maxDegree, y.maxDegree));
+    }
+
+    // result = (*this)^k mod modulus by binary exponentiation. Every square is reduced
+    // right away, so operands stay below deg modulus, and all the reductions share
+    // one reciprocal of the modulus. Returns false under the same conditions as divide().
+    bool powMod(uint64_t k, const BasicPolynomial &modulus, BasicPolynomial &result) const {
+        Array m = modulus.toArray();
+        if (m.empty() || !Traits::invertible(m.back())) return false;
+        Array reciprocal, quotient, base, power;
+        divideArrays(toArray(), m, reciprocal, quotient, base);
+        divideArrays(Array{Ring(1)}, m, reciprocal, quotient, power);
+        for (; k; k >>= 1) {
+            if (k & 1) divideArrays(multiplyArrays(power, base), m, reciprocal, quotient, power);
+            if (k > 1) divideArrays(multiplyArrays(base, base), m, reciprocal, quotient, base);
+        }
+        result = fromArray(move(power), modulus.maxDegree);
+        return true;
+    }
+
+    // Reference version of powMod(): k schoolbook multiplications, each followed by long division
+    bool powModNaive(uint64_t k, const BasicPolynomial &modulus, BasicPolynomial &result) const {
+        Array m = modulus.toArray();
+        if (m.empty() || !Traits::invertible(m.back())) return false;
+        Array quotient, base, power;
+        longDivide(toArray(), m, quotient, base);
+        longDivide(Array{Ring(1)}, m, quotient, power);
+        for (uint64_t i = 0; i < k && !power.empty() && !base.empty(); ++i) {
+            Array product(power.size() + base.size() - 1, Ring(0));
+            multiplySchoolbook(power.data(), power.size(), base.data(), base.size(), product.data());
+            trim(product);
+            longDivide(product, m, quotient, power);
+        }
+        if (base.empty() && k > 0) power.clear();
+        result = fromArray(move(power), modulus.maxDegree);
+        return true;
+    }
 };
 
+using Polynomial = BasicPolynomial<>;  // int coefficients, arithmetic modulo 2^32
+
+// Open-addressing hash table from packed monomial to coefficient, for adding up
+// terms that arrive in any order: linear probing over a power-of-two array that
+// doubles at half load. Cancelled terms keep their slot with a zero coefficient.
+template <typename Ring>
+class MonomialTable {
+public:
+    static constexpr uint64_t emptyKey = ~uint64_t(0);  // Never a valid monomial (see BasicMultiPolynomial)
+
+    void add(uint64_t key, Ring c) {
+        if (2 * (used + 1) > slots.size()) grow();
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i].key == key) {
+                slots[i].value += c;
+                return;
+            }
+            if (slots[i].key == emptyKey) {
+                slots[i] = {key, c};
+                ++used;
+                return;
+            }
+        }
+    }
+
+    size_t size() const { return used; }
+
+    // Visit every (key, coefficient) with a nonzero coefficient, in slot order
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const Slot& s : slots) {
+            if (s.key != emptyKey && s.value != Ring(0)) visit(s.key, s.value);
+        }
+    }
+
+    void clear() {
+        slots = vector<Slot>();
+        used = 0;
+    }
+
+private:
+    struct Slot {
+        uint64_t key;
+        Ring value;
+    };
+    vector<Slot> slots;
+    size_t used = 0;
+
+    static size_t hash(uint64_t key) {  // MurmurHash3 finalizer: neighbouring monomials land far apart
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    void grow() {
+        vector<Slot> old = move(slots);
+        slots.assign(max<size_t>(16, 2 * old.size()), Slot{emptyKey, Ring(0)});
+        used = 0;
+        for (const Slot& s : old) {
+            if (s.key != emptyKey) add(s.key, s.value);
+        }
+    }
+};
+
+// Sparse polynomial in several variables x1, ..., xn (n <= 32), with coefficients of
+// type T as for BasicPolynomial. Each monomial's exponent vector is packed into one
+// 64-bit key, 64 / n bits per variable with x1 in the highest field, so comparing
+// keys compares monomials lexicographically and multiplying monomials is adding
+// keys. The top bit of every field is a guard that valid exponents never use: an
+// exponent that overflows in a product sets it instead of carrying into the next
+// variable, and the product throws overflow_error.
+//
+// Terms added one by one go into a MonomialTable, so like terms combine in O(1)
+// whatever the order; the table is sorted into a term list only when an operation
+// needs the terms in order.
+template <typename T = int>
+class BasicMultiPolynomial {
+private:
+    using Ring = typename CoefficientTraits<T>::Ring;
+
+    struct Term {
+        uint64_t monomial;
+        Ring coefficient;
+    };
+
+    int variables;
+    int bits;           // Field width per variable, guard bit included
+    uint64_t guards;    // The guard bit of every field
+    // Exactly one of these holds the terms: the table while terms are being added,
+    // the sorted list (ascending monomials, no zero coefficients) otherwise. Sorting
+    // happens on demand inside const operations, so they are not safe to call
+    // concurrently on one polynomial.
+    mutable MonomialTable<Ring> table;
+    mutable vector<Term> sorted;
+    mutable bool hashed = false;
+
+    int shift(int variable) const { return (variables - 1 - variable) * bits; }
+
+    // Keys of polynomials in different numbers of variables pack the exponents in
+    // different fields, so combining them would silently mix up the variables
+    void requireSameVariables(const BasicMultiPolynomial &other) const {
+        if (other.variables != variables) throw invalid_argument("polynomials have different numbers of variables");
+    }
+
+    const vector<Term>& sortedTerms() const {
+        if (hashed) {
+            sorted.clear();
+            sorted.reserve(table.size());
+            table.forEach([&](uint64_t monomial, Ring c) { sorted.push_back({monomial, c}); });
+            sort(sorted.begin(), sorted.end(), [](const Term& x, const Term& y) { return x.monomial < y.monomial; });
+            table.clear();
+            hashed = false;
+        }
+        return sorted;
+    }
+
+public:
+    // Highest exponent a single variable can reach
+    int maxExponent() const { return int(min<uint64_t>(INT_MAX, (uint64_t(1) << (bits - 1)) - 1)); }
+
+    BasicMultiPolynomial(int variables) : variables(clamp(variables, 1, 32)), bits(64 / this->variables), guards(0) {
+        for (int k = 0; k < this->variables; ++k) guards |= uint64_t(1) << (shift(k) + bits - 1);
+    }
+
+    // The polynomial x_k (0-based variable index)
+    static BasicMultiPolynomial variable(int variables, int k) {
+        BasicMultiPolynomial result(variables);
+        vector<int> exponents(result.variables, 0);
+        exponents[k] = 1;
+        result.addTerm(exponents, T(1));
+        return result;
+    }
+
+    // Add coefficient * x1^e1 ... xn^en, combining with an existing term of the same
+    // monomial. Returns false if there is not one exponent per variable or one is
+    // outside [0, maxExponent()].
+    bool addTerm(span<const int> exponents, T coefficient) {
+        if (int(exponents.size()) != variables) return false;
+        uint64_t monomial = 0;
+        for (int k = 0; k < variables; ++k) {
+            if (exponents[k] < 0 || exponents[k] > maxExponent()) return false;
+            monomial |= uint64_t(exponents[k]) << shift(k);
+        }
+        if (!hashed) {
+            for (const Term& t : sorted) table.add(t.monomial, t.coefficient);
+            sorted = vector<Term>();
+            hashed = true;
+        }
+        table.add(monomial, Ring(coefficient));
+        return true;
+    }
+
+    size_t termCount() const { return sortedTerms().size(); }
+
+    // Exponent of variable k in a packed monomial
+    int exponent(uint64_t monomial, int k) const { return int((monomial >> shift(k)) & (~uint64_t(0) >> (64 - bits))); }
+
+    // Terms in descending lexicographic order, e.g. 1x1^2 + -1x2^2
+    void display() const {
+        const vector<Term>& list = sortedTerms();
+        bool isFirst = true;
+        for (auto it = list.rbegin(); it != list.rend(); ++it) {
+            if (!isFirst) cout << " + ";
+            cout << T(it->coefficient);
+            for (int k = 0; k < variables; ++k) {
+                if (int e = exponent(it->monomial, k)) cout << "x" << k + 1 << "^" << e;
+            }
+            isFirst = false;
+        }
+        if (isFirst) cout << 0;
+        cout << endl;
+    }
+
+    // Value at the point (point[0], ..., point[n - 1]); missing coordinates count as 0
+    T evaluate(span<const T> point) const {
+        Ring result = Ring(0);
+        for (const Term& t : sortedTerms()) {
+            Ring product = t.coefficient;
+            for (int k = 0; k < variables; ++k) {
+                Ring x = k < int(point.size()) ? Ring(point[k]) : Ring(0);
+                for (int e = exponent(t.monomial, k); e; e >>= 1, x *= x) {
+                    if (e & 1) product *= x;
+                }
+            }
+            result += product;
+        }
+        return T(result);
+    }
+
+    // Sum: one merge of the two sorted term lists. Throws invalid_argument if the
+    // operands have different numbers of variables.
+    BasicMultiPolynomial operator+(const BasicMultiPolynomial &other) const {
+        requireSameVariables(other);
+        BasicMultiPolynomial result(variables);
+        const vector<Term>& a = sortedTerms();
+        const vector<Term>& b = other.sortedTerms();
+        result.sorted.reserve(a.size() + b.size());
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size()) {
+            if (j == b.size() || (i < a.size() && a[i].monomial < b[j].monomial)) {
+                result.sorted.push_back(a[i++]);
+            } else if (i == a.size() || b[j].monomial < a[i].monomial) {
+                result.sorted.push_back(b[j++]);
+            } else {
+                Ring sum = a[i].coefficient + b[j].coefficient;
+                if (sum != Ring(0)) result.sorted.push_back({a[i].monomial, sum});
+                ++i, ++j;
+            }
+        }
+        return result;
+    }
+
+    // Product by Johnson's heap method: the products a[i] * b[j] for fixed i come out
+    // of the sorted b in increasing order, so a heap holding the next pending product
+    // of each a[i] yields the whole product in sorted order, and like terms arrive
+    // next to each other. Working memory is one heap entry per term of the shorter
+    // operand, instead of a table sized to all the term products. Throws
+    // invalid_argument if the operands have different numbers of variables.
+    BasicMultiPolynomial operator*(const BasicMultiPolynomial &other) const {
+        requireSameVariables(other);
+        BasicMultiPolynomial result(variables);
+        const vector<Term>* a = &sortedTerms();
+        const vector<Term>* b = &other.sortedTerms();
+        if (a->size() > b->size()) swap(a, b);
+        if (a->empty()) return result;
+
+        struct Pending {
+            uint64_t monomial;
+            uint32_t i, j;  // a[i] * b[j]
+        };
+        auto later = [](const Pending& x, const Pending& y) { return x.monomial > y.monomial; };
+        vector<Pending> heap;
+        heap.reserve(a->size());
+        for (uint32_t i = 0; i < a->size(); ++i) heap.push_back({(*a)[i].monomial + (*b)[0].monomial, i, 0});
+        make_heap(heap.begin(), heap.end(), later);
+        while (!heap.empty()) {
+            uint64_t monomial = heap.front().monomial;
+            if (monomial & guards) throw overflow_error("monomial exponent overflow");
+            Ring sum = Ring(0);
+            while (!heap.empty() && heap.front().monomial == monomial) {
+                pop_heap(heap.begin(), heap.end(), later);
+                Pending& p = heap.back();
+                sum += (*a)[p.i].coefficient * (*b)[p.j].coefficient;
+                if (++p.j < b->size()) {
+                    p.monomial = (*a)[p.i].monomial + (*b)[p.j].monomial;
+                    push_heap(heap.begin(), heap.end(), later);
+                } else {
+                    heap.pop_back();
+                }
+            }
+            if (sum != Ring(0)) result.sorted.push_back({monomial, sum});
+        }
+        return result;
+    }
+};
+
+using MultiPolynomial = BasicMultiPolynomial<>;  // int coefficients, arithmetic modulo 2^32
+
+// Time divide(), gcd() and powMod() against their reference versions on random
+// polynomials modulo 998244353 of doubling degree. The quadratic references are
+// skipped above `naiveLimit`, where they would run for minutes. Prints milliseconds.
+void benchmarkDivision(int maxDegree = 1 << 20, int naiveLimit = 1 << 13) {
+    using Field = BasicPolynomial<ModInt<998244353>>;
+    mt19937 rng(7);
+    auto random = [&](int degree) {
+        Field p(degree);
+        for (int i = 0; i <= degree; ++i) p.setCoefficient(i, int64_t(rng()));
+        p.setCoefficient(degree, 1);
+        return p;
+    };
+    auto column = [](bool run, auto work) {
+        if (!run) {
+            cout << "  -";
+            return;
+        }
+        auto begin = chrono::steady_clock::now();
+        work();
+        cout << "  " << chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    };
+    cout << "degree  divide  naive  gcd  naive  powMod (milliseconds)" << endl;
+    for (int n = 1024; n <= maxDegree; n *= 2) {
+        Field a = random(2 * n), b = random(n), c = random(n), q(0), r(0), x(1);
+        x.setCoefficient(1, 1);
+        bool naive = n <= naiveLimit;
+        cout << n;
+        column(true, [&] { a.divide(b, q, r); });
+        column(naive, [&] { a.divideNaive(b, q, r); });
+        column(true, [&] { Field::gcd(b, c); });
+        column(naive, [&] { Field::gcdNaive(b, c); });
+        column(true, [&] { x.powMod(1000000000000000000, b, r); });
+        cout << endl;
+    }
+}
+
+// Differential check of divide(), gcd() and powMod() against their naive versions,
+// and of the half-GCD reduction against plain Euclid, on random inputs modulo
+// 998244353, with the cutoffs lowered so that Newton division and the half-GCD
+// recursion run even at these small degrees. Returns how many cases agreed.
+int checkDivisionAgainstNaive(int cases = 40) {
+    using Field = BasicPolynomial<ModInt<998244353>>;
+    MultiplyCutoffs saved = Field::cutoffs;
+    Field::cutoffs.division = 4;
+    Field::cutoffs.gcd = 32;
+    Field::cutoffs.halfGcd = 8;
+    mt19937 rng(18);
+    auto random = [&](int degree) {
+        Field p(degree);
+        for (int i = 0; i <= degree; ++i) p.setCoefficient(i, int64_t(rng()));
+        return p;
+    };
+    auto same = [](const Field& p, const Field& q) { return (p - q).degree() == -1; };
+    int agreed = 0;
+    for (int i = 0; i < cases; ++i) {
+        // A shared factor makes the GCD nontrivial
+        Field common = random(rng() % 40), a = random(40 + rng() % 160) * common, b = random(20 + rng() % 120) * common;
+        Field divisor = random(20 + rng() % 60), q(0), r(0), qNaive(0), rNaive(0), power(0), powerNaive(0);
+        uint64_t k = rng() % 4096;  // powModNaive() takes k steps
+        bool ok = a.divide(divisor, q, r) && a.divideNaive(divisor, qNaive, rNaive) && same(q, qNaive) && same(r, rNaive)
+                  && same(Field::gcd(a, b), Field::gcdNaive(a, b)) && Field::halfGcdMatchesEuclid(divisor, r)
+                  && a.powMod(k, divisor, power) && a.powModNaive(k, divisor, powerNaive) && same(power, powerNaive);
+        agreed += ok;
+    }
+    Field::cutoffs = saved;
+    return agreed;
+}
+
+// Heap allocations made so far, for counting the temporaries an expression creates,
+// and the bytes in use now and at most, for the memory it peaks at
+atomic<size_t> allocationCount{0};
+atomic<size_t> allocatedBytes{0};
+atomic<size_t> peakAllocatedBytes{0};
+
+// Each block is preceded by its size, so that delete can subtract it
+constexpr size_t allocationHeader = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+// Not inlined, so the compiler never sees new-allocated memory reach free() directly
+__attribute__((noinline)) void* operator new(size_t size) {
+    ++allocationCount;
+    char* block = static_cast<char*>(malloc(size + allocationHeader));
+    if (!block) throw bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+    size_t inUse = allocatedBytes += size;
+    for (size_t peak = peakAllocatedBytes; inUse > peak && !peakAllocatedBytes.compare_exchange_weak(peak, inUse);) {}
+    return block + allocationHeader;
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    if (!p) return;
+    char* block = static_cast<char*>(p) - allocationHeader;
+    allocatedBytes -= *reinterpret_cast<size_t*>(block);
+    free(block);
+}
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// Time the kernels on random operands of doubling size and return the sizes where
+// one Karatsuba level starts beating schoolbook and NTT starts beating Karatsuba
+// on this machine. Prints the timings as it goes. The Karatsuba column always
+// recurses down to the default cutoff, so NTT is compared against real Karatsuba,
+// and a crossover that never shows up within maxSize is put past the largest size timed.
+MultiplyCutoffs benchmarkMultiplyCutoffs(size_t maxSize = 4096) {
+    mt19937 rng(42);
+    MultiplyCutoffs found;
+    const size_t base = found.karatsuba;
+    bool karatsubaFound = false, nttFound = false;
+    cout << "size  schoolbook  karatsuba  ntt (microseconds per product)" << endl;
+    for (size_t n = 8; n <= maxSize; n *= 2) {
+        vector<unsigned> a(n), b(n), out(2 * n - 1);
+        for (size_t i = 0; i < n; ++i) a[i] = rng(), b[i] = rng();
+        size_t repeats = max<size_t>(1, 65536 / n);
+        auto time = [&](auto kernel) {
+            auto begin = chrono::steady_clock::now();
+            for (size_t r = 0; r < repeats; ++r) {
+                fill(out.begin(), out.end(), 0u);
+                kernel();
+            }
+            return chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count() / repeats;
+        };
+        double schoolbook = time([&] { multiplySchoolbook(a.data(), n, b.data(), n, out.data()); });
+        vector<unsigned> scratch(karatsubaScratchSize(n, 2));
+        double oneLevel = time([&] { multiplyKaratsuba(a.data(), b.data(), n, out.data(), n / 2 + 1, scratch.data()); });
+        double karatsuba = time([&] { multiplyKaratsuba(a.data(), b.data(), n, out.data(), base, scratch.data()); });
+        double ntt = time([&] { multiplyNtt<int>(a, b); });
+        cout << n << "  " << schoolbook << "  " << karatsuba << "  " << ntt << endl;
+        if (!karatsubaFound && oneLevel < schoolbook) found.karatsuba = n, karatsubaFound = true;
+        if (!nttFound && ntt < karatsuba) found.ntt = n, nttFound = true;
+    }
+    // A kernel that lost at every size tried only takes over past the largest size
+    // measured, where its better asymptotics are left to win
+    size_t beyond = 2 * bit_floor(maxSize);
+    if (!karatsubaFound) {
+        found.karatsuba = beyond;
+        cout << "Karatsuba never beat schoolbook up to " << maxSize << " terms; using it from " << beyond << endl;
+    }
+    if (!nttFound) {
+        found.ntt = beyond;
+        cout << "NTT never beat Karatsuba up to " << maxSize << " terms; using it from " << beyond << endl;
+    }
+    return found;
+}
+
 int main() {
     // Creating two polynomials: 3x^2 + 5 and 4x^3 + 2x + 1
     Polynomial p1(2);  // Max degree 2
@@ -105,6 +1763,198 @@ int main() {
     // Evaluating the sum at x = 2
     cout << "Evaluation of sum at x = 2: " << p3.evaluate(2) << endl;
 
+    // High degree, few terms: stored as a sorted term list, not a million coefficients
+    Polynomial big(1000000);
+    big.setCoefficient(1000000, 1);  // x^1000000
+    big.setCoefficient(0, 1);        // + 1
+    Polynomial bigSum = big + p2;
+    cout << "Sum of x^1000000 + 1 and Polynomial 2: ";
+    bigSum.display();
+    cout << "Stored as " << (bigSum.isSparse() ? "sparse" : "dense") << " with " << bigSum.termCount()
+         << " terms, evaluation at x = -1: " << bigSum.evaluate(-1) << endl;
+
+    // Multiplying two polynomials
+    Polynomial p4 = p1 * p2;
+    cout << "Product of Polynomial 1 and 2: ";
+    p4.display();
+
+    // Pick the kernel cutoffs for this machine, then multiply two 50000-term polynomials
+    Polynomial::cutoffs = benchmarkMultiplyCutoffs();
+    cout << "Installed cutoffs: Karatsuba from " << Polynomial::cutoffs.karatsuba << " terms, NTT from " << Polynomial::cutoffs.ntt
+         << " terms" << endl;
+    Polynomial a(49999), b(49999);
+    for (int i = 0; i < 50000; ++i) {
+        a.setCoefficient(i, i % 7 + 1);
+        b.setCoefficient(i, 1000000 - i);
+    }
+    Polynomial ab = a * b;
+    cout << "Large product has degree " << ab.degree() << "; matches a(3) * b(3) at x = 3? "
+         << (ab.evaluate(3) == int(unsigned(a.evaluate(3)) * unsigned(b.evaluate(3))) ? "Yes" : "No") << endl;
+
+    // Evaluating at many points at once
+    vector<int> xs = {-2, -1, 0, 1, 2, 3}, values(xs.size());
+    p3.evaluateMany(xs, values, EvalScheme::Estrin);
+    cout << "Sum evaluated at x = -2..3:";
+    for (int v : values) cout << " " << v;
+    cout << endl;
+    Polynomial c(63);
+    for (int i = 0; i <= 63; ++i) c.setCoefficient(i, i % 7 + 1);
+    vector<int> manyXs(1000000), manyValues(manyXs.size());
+    iota(manyXs.begin(), manyXs.end(), -500000);
+    auto begin = chrono::steady_clock::now();
+    c.evaluateMany(manyXs, manyValues);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    bool same = true;
+    for (size_t i = 0; i < manyXs.size(); i += 9973) same = same && manyValues[i] == c.evaluate(manyXs[i]);
+    cout << "Evaluated a 64-term polynomial at " << manyXs.size() << " points in " << ms
+         << " ms; matches evaluate()? " << (same ? "Yes" : "No") << endl;
+    {
+        // Past cutoffs.evaluation a modular polynomial goes through the subproduct tree
+        using Field = BasicPolynomial<ModInt<998244353>>;
+        Field f(8191);
+        for (int i = 0; i <= 8191; ++i) f.setCoefficient(i, ModInt<998244353>(i * 7919 + 1));
+        vector<ModInt<998244353>> points(8192), results(points.size());
+        for (size_t i = 0; i < points.size(); ++i) points[i] = ModInt<998244353>(i * i + 3);
+        begin = chrono::steady_clock::now();
+        f.evaluateMany(points, results, EvalScheme::Horner, 1);
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        bool agree = true;
+        for (size_t i = 0; i < points.size(); i += 997) agree = agree && results[i] == f.evaluate(points[i]);
+        cout << "Evaluated a degree-8191 polynomial mod 998244353 at " << points.size() << " points in " << ms
+             << " ms through the subproduct tree; matches evaluate()? " << (agree ? "Yes" : "No") << endl;
+    }
+
+    // Other coefficient types: exact arithmetic modulo a prime, 128-bit integers,
+    // doubles, and a checked mode that reports overflow instead of wrapping
+    BasicPolynomial<ModInt<998244353>> modular(2);
+    modular.setCoefficient(2, 123456789);
+    modular.setCoefficient(0, 987654321);
+    cout << "Square of 123456789x^2 + 987654321 modulo 998244353: ";
+    (modular * modular).display();
+    BasicPolynomial<__int128> wide(1);
+    wide.setCoefficient(1, INT64_MAX);
+    wide.setCoefficient(0, 1);
+    cout << "Square of 9223372036854775807x + 1 in 128 bits: ";
+    (wide * wide).display();
+    BasicPolynomial<double> real(2);
+    real.setCoefficient(2, 0.5);
+    real.setCoefficient(0, -0.25);
+    cout << "0.5x^2 - 0.25 at x = 1.5: " << real.evaluate(1.5) << endl;
+    BasicPolynomial<Checked<int>> checked(1);
+    checked.setCoefficient(1, 65536);
+    try {
+        (checked * checked).display();
+    } catch (const overflow_error& error) {
+        cout << "Checked square of 65536x: " << error.what() << endl;
+    }
+
+    // Division, GCD and powers modulo a polynomial
+    Polynomial divisor(2), quotient(0), remainder(0);
+    divisor.setCoefficient(2, 1);
+    divisor.setCoefficient(0, 1);
+    if (p3.divide(divisor, quotient, remainder)) {
+        cout << "Sum divided by x^2 + 1: quotient ";
+        quotient.display();
+        cout << "  remainder ";
+        remainder.display();
+    }
+    using Field = BasicPolynomial<ModInt<998244353>>;
+    Field f(3), g(3);
+    for (int e : {3, 2, 1, 0}) f.setCoefficient(e, array{1, 2, -1, -2}[3 - e]);  // (x^2 - 1)(x + 2)
+    for (int e : {3, 2, 1, 0}) g.setCoefficient(e, array{1, -3, -1, 3}[3 - e]);  // (x^2 - 1)(x - 3)
+    cout << "gcd((x^2 - 1)(x + 2), (x^2 - 1)(x - 3)) modulo 998244353: ";
+    Field::gcd(f, g).display();
+    Field x(1), fibonacci(2), xPower(0);
+    x.setCoefficient(1, 1);
+    for (int e : {2, 1, 0}) fibonacci.setCoefficient(e, e == 2 ? 1 : -1);  // x^2 - x - 1
+    x.powMod(1000000000000000000, fibonacci, xPower);  // x^n = F(n) x + F(n - 1)
+    cout << "F(10^18) modulo 998244353 from x^(10^18) mod (x^2 - x - 1): " << xPower.evaluate(1) - xPower.evaluate(0) << endl;
+    benchmarkDivision(1 << 11, 1 << 11);
+    cout << "Fast division, GCD and powMod agree with the naive versions (lowered cutoffs): "
+         << checkDivisionAgainstNaive() << " of 40 cases" << endl;
+
+    // Chained sums: count heap allocations with named temporaries, with the rvalue
+    // overloads reusing each temporary, and with sum()
+    vector<Polynomial> q;
+    for (int k = 1; k <= 4; ++k) {
+        q.emplace_back(999);
+        for (int i = 0; i < 1000; ++i) q.back().setCoefficient(i, k * i + 1);
+    }
+    size_t before = allocationCount;
+    Polynomial q12 = q[0] + q[1];
+    Polynomial q123 = q12 + q[2];
+    Polynomial named = q123 + q[3];
+    size_t namedAllocations = allocationCount - before;
+    before = allocationCount;
+    Polynomial chained = q[0] + q[1] + q[2] + q[3];
+    size_t chainedAllocations = allocationCount - before;
+    before = allocationCount;
+    Polynomial fused = Polynomial::sum(q[0], q[1], q[2], q[3]);
+    size_t fusedAllocations = allocationCount - before;
+    before = allocationCount;
+    named -= q[3];
+    named += q[3];
+    size_t inPlaceAllocations = allocationCount - before;
+    cout << "Allocations for q1 + q2 + q3 + q4: " << namedAllocations << " with named temporaries, "
+         << chainedAllocations << " chained, " << fusedAllocations << " with sum(), "
+         << inPlaceAllocations << " for -= and +=; results equal? "
+         << (named.evaluate(3) == chained.evaluate(3) && chained.evaluate(3) == fused.evaluate(3) ? "Yes" : "No") << endl;
+
+    // A million low-degree polynomials: their coefficients stay inside the objects,
+    // so building, multiplying and adding them never touches the heap
+    before = allocationCount;
+    int highest = 0;
+    for (int i = 1; i <= 1000000; ++i) {
+        Polynomial small(3);
+        small.setCoefficient(3, i);
+        small.setCoefficient(0, 1);
+        Polynomial result = small * small + small;
+        highest = max(highest, result.degree());
+    }
+    Polynomial cancelled = p2 - p2;
+    cout << "A million products of degree " << highest << " took " << allocationCount - before
+         << " heap allocations; p2 - p2 has degree " << cancelled.degree() << endl;
+
+    // A dense cubic plus the sparse x^100000000 + 1 has six terms, so it should never
+    // need room for a hundred million coefficients, whichever way it is added
+    Polynomial far(100000000);
+    far.setCoefficient(100000000, 1);
+    far.setCoefficient(0, 1);
+    auto peakBytes = [](auto add) {
+        size_t base = allocatedBytes;
+        peakAllocatedBytes = base;
+        size_t terms = add().termCount();
+        return make_pair(peakAllocatedBytes - base, terms);
+    };
+    auto [plusBytes, plusTerms] = peakBytes([&] { return p2 + far; });
+    auto [inPlaceBytes, inPlaceTerms] = peakBytes([&] { Polynomial r = p2; r += far; return r; });
+    auto [sumBytes, sumTerms] = peakBytes([&] { return Polynomial::sum(p2, far); });
+    cout << "Peak bytes for 4x^3 + 2x + 1 plus x^100000000 + 1: " << plusBytes << " with +, " << inPlaceBytes
+         << " with +=, " << sumBytes << " with sum() (" << plusTerms << ", " << inPlaceTerms << " and "
+         << sumTerms << " terms)" << endl;
+
+    // Multivariate: (x1 + x2)(x1 - x2), then Fateman's benchmark f (f + 1) for
+    // f = (1 + x1 + x2 + x3 + x4)^8
+    MultiPolynomial x1 = MultiPolynomial::variable(4, 0), x2 = MultiPolynomial::variable(4, 1);
+    MultiPolynomial minusX2(4);
+    minusX2.addTerm(array{0, 1, 0, 0}, -1);
+    cout << "(x1 + x2)(x1 - x2) = ";
+    ((x1 + x2) * (x1 + minusX2)).display();
+    MultiPolynomial base(4), one(4);
+    one.addTerm(array{0, 0, 0, 0}, 1);
+    for (int k = 0; k < 4; ++k) base = base + MultiPolynomial::variable(4, k);
+    base = base + one;
+    MultiPolynomial fateman = one;
+    for (int i = 0; i < 8; ++i) fateman = fateman * base;
+    auto multiStart = chrono::steady_clock::now();
+    MultiPolynomial fatemanProduct = fateman * (fateman + one);
+    double multiMs = chrono::duration<double, milli>(chrono::steady_clock::now() - multiStart).count();
+    array point{1, 2, -1, 3};
+    int fAtPoint = fateman.evaluate(point);
+    cout << "f (f + 1) has " << fatemanProduct.termCount() << " terms (f has " << fateman.termCount() << "), computed in "
+         << multiMs << " ms; matches f(p) (f(p) + 1) at p = (1, 2, -1, 3)? "
+         << (fatemanProduct.evaluate(point) == int(unsigned(fAtPoint) * unsigned(fAtPoint + 1)) ? "Yes" : "No") << endl;
+
     return 0;
 }
 ```
@@ -126,6 +1976,50 @@ int main() {
 3. **Evaluation**:
    - Evaluates the polynomial by plugging in a value for `x` and calculating the result using basic math operations.
 
+4. **Sparse and Dense Storage**:
+   - Coefficients are kept either as a dense array indexed by exponent or as a sorted list of nonzero (exponent, coefficient) terms, and the class switches automatically based on how full the array would be.
+   - Addition merges the two term lists in one linear pass, and sparse evaluation raises `x` to each gap between exponents by squaring, so time and memory follow the number of terms rather than the degree.
+
+5. **Multiplication**:
+   - The `*` operator multiplies sparse polynomials term by term, and dense ones with schoolbook multiplication for small sizes, Karatsuba (three half-size products instead of four) for medium sizes, and a number-theoretic transform for large ones.
+   - The NTT runs modulo three primes and recombines each coefficient with the Chinese remainder theorem, so the product is exact rather than rounded like a floating-point FFT.
+   - Karatsuba recursion works in one scratch buffer allocated up front, and the schoolbook kernel at its base runs in fixed blocks of 8 so that it vectorizes there too.
+   - `Polynomial::cutoffs` holds the sizes where the kernels switch; `benchmarkMultiplyCutoffs()` times the kernels on the host machine and returns the measured crossovers. A crossover that never appears within the sizes tried is set past the largest size measured, so a kernel that lost everywhere is never installed where it was timed; `main()` prints the cutoffs it installs.
+
+6. **Batch Evaluation**:
+   - `evaluateMany()` evaluates one polynomial at many points. Horner's rule runs in AVX-512 or AVX2 lanes (8 or 16 points per instruction, chosen at runtime) with a scalar fallback, and large batches are split across threads. Above degree `cutoffs.evaluation` (1024), with at least as many points, modular coefficients switch to a subproduct tree: the products of (x - x_i) are built bottom-up with NTT multiplication, and P is reduced modulo them top-down with the Newton `divide()`, until each leaf of 32 points evaluates a remainder of degree < 32. int coefficients stay on the SIMD lanes, which beat the tree up to about 2^18 points.
+   - Estrin's scheme combines terms pairwise with `x`, `x^2`, `x^4`, ..., which shortens the chain of dependent multiplications when there are only a few points.
+
+7. **Coefficient Types**:
+   - `BasicPolynomial<T>` takes the coefficient type as a template parameter; `Polynomial` is `BasicPolynomial<int>`, whose arithmetic wraps modulo 2^32.
+   - `ModInt<P>` gives exact arithmetic modulo a prime using Montgomery multiplication, `long long` and `__int128` give wider integers, and `double` gives real coefficients.
+   - `Checked<T>` throws `overflow_error` when a coefficient overflows instead of wrapping silently; it multiplies with the schoolbook kernel only, since Karatsuba's intermediate sums can overflow when the final product does not.
+   - `CoefficientTraits<T>` tells the kernels which types can go through the exact NTT (`int` and `ModInt`); the others use schoolbook and Karatsuba.
+
+8. **In-Place and Chained Arithmetic**:
+   - `+=`, `-=` and `*=` update a polynomial in place. A dense array only grows when the other operand reaches past it, and sparse term lists are merged from the back within the existing vector.
+   - When an operand of `+` or `-` is a temporary, its storage becomes the result, so `p1 + p2 + p3 + p4` allocates once for `p1 + p2` and adds the rest in place instead of creating a new polynomial per `+`.
+   - `Polynomial::sum(p1, p2, ...)` sizes the result once for all operands and then adds each one, which is a single allocation whatever mix of dense and sparse inputs it gets. The form of the result is chosen from the total term count and the highest degree alone.
+   - Adding a sparse polynomial that reaches far past a dense one switches the dense one to terms first, so a cubic plus `x^100000000 + 1` never allocates room for a hundred million coefficients.
+
+9. **Division, GCD and Modular Powers**:
+   - `divide()` returns the quotient and remainder. For long quotients it multiplies by a Newton-iteration reciprocal of the reversed divisor, which doubles in precision each step, so division costs a few multiplications instead of long division's quadratic time. It returns `false` when the divisor is zero or its leading coefficient has no inverse, for example an even one with `int` coefficients.
+   - `gcd()` is defined when the coefficients form a field (`ModInt`). It uses the half-GCD algorithm, which finds the first half of Euclid's quotients recursively from the top coefficients, for O(M(n) log n) time.
+   - `powMod(k, m, result)` computes `p^k mod m` by repeated squaring, reducing after every step. All the reductions reuse one reciprocal of `m`.
+   - `divideNaive()`, `gcdNaive()` and `powModNaive()` are straightforward reference versions for differential testing, and `halfGcdMatchesEuclid()` checks that the half-GCD step stops on the same remainder pair as plain Euclid. `checkDivisionAgainstNaive()` runs them on random inputs with the cutoffs lowered to `gcd = 32` and `halfGcd = 8`, since the demo degrees never reach the default GCD cutoff. `benchmarkDivision()` times both versions up to degree 2^20 and skips the quadratic ones where they would take too long.
+   - When the coefficients are `ModInt<998244353>`, products need only one NTT instead of three, because that modulus is itself the first NTT prime.
+
+10. **Normalized Storage**:
+    - Every operation leaves the coefficients normalized: the dense array never ends in a zero coefficient and the term list holds no zero terms. `degree()` is therefore O(1), and `display()` and `evaluate()` stop at the leading coefficient. For example, `p2 - p2` is the empty zero polynomial rather than four zeros.
+    - The dense array is a `SmallVec` that stores up to 8 coefficients inside the polynomial object. Polynomials below degree 8 always use it, so creating, adding and multiplying them makes no heap allocation.
+
+11. **Multivariate Polynomials**:
+    - `MultiPolynomial` (`BasicMultiPolynomial<T>`) holds sparse polynomials in up to 32 variables. Each exponent vector is packed into one 64-bit key with `64 / n` bits per variable, so comparing keys orders monomials lexicographically and multiplying monomials is a single addition.
+    - The top bit of each field is a guard. An exponent that overflows in a product sets that bit instead of corrupting the next variable, and the product throws `overflow_error`. Adding or multiplying polynomials with different numbers of variables throws `invalid_argument`, since their keys pack the exponents differently.
+    - `addTerm()` accumulates into an open-addressing hash table, so like terms combine in O(1) in any order. The terms are sorted only when an operation needs them in order.
+    - Multiplication uses Johnson's heap method. A heap holds one pending product per term of the smaller operand and emits the product terms already sorted, so working memory stays proportional to the inputs rather than to the number of term products.
+    - The univariate `Polynomial` is unchanged.
+
 ---
 
 ### **Sample Output:**
@@ -133,7 +2027,29 @@ int main() {
 Polynomial 1: 3x^2 + 5x^0
 Polynomial 2: 4x^3 + 2x^1 + 1x^0
 Sum of Polynomial 1 and 2: 4x^3 + 3x^2 + 2x^1 + 6x^0
-Evaluation of sum at x = 2: 62
+Evaluation of sum at x = 2: 54
+Sum of x^1000000 + 1 and Polynomial 2: 1x^1000000 + 4x^3 + 2x^1 + 2x^0
+Stored as sparse with 4 terms, evaluation at x = -1: -3
+Product of Polynomial 1 and 2: 12x^5 + 26x^3 + 3x^2 + 10x^1 + 5x^0
+(benchmark table and cutoffs: timings vary by machine)
+Large product has degree 99998; matches a(3) * b(3) at x = 3? Yes
+Sum evaluated at x = -2..3: -18 3 6 15 54 147
+Evaluated a 64-term polynomial at 1000000 points in ... ms; matches evaluate()? Yes
+Evaluated a degree-8191 polynomial mod 998244353 at 8192 points in ... ms through the subproduct tree; matches evaluate()? Yes
+Square of 123456789x^2 + 987654321 modulo 998244353: 642754969x^4 + 527369470x^2 + 17678886x^0
+Square of 9223372036854775807x + 1 in 128 bits: 85070591730234615847396907784232501249x^2 + 18446744073709551614x^1 + 1x^0
+0.5x^2 - 0.25 at x = 1.5: 0.875
+Checked square of 65536x: polynomial coefficient overflow
+Sum divided by x^2 + 1: quotient 4x^1 + 3x^0
+  remainder -2x^1 + 3x^0
+gcd((x^2 - 1)(x + 2), (x^2 - 1)(x - 3)) modulo 998244353: 1x^2 + 998244352x^0
+F(10^18) modulo 998244353 from x^(10^18) mod (x^2 - x - 1): 23849548
+(division benchmark table: timings vary by machine)
+Allocations for q1 + q2 + q3 + q4: 3 with named temporaries, 1 chained, 1 with sum(), 0 for -= and +=; results equal? Yes
+A million products of degree 6 took 0 heap allocations; p2 - p2 has degree -1
+Peak bytes for 4x^3 + 2x + 1 plus x^100000000 + 1: 72 with +, 72 with +=, 40 with sum() (4, 4 and 4 terms)
+(x1 + x2)(x1 - x2) = 1x1^2 + -1x2^2
+f (f + 1) has 4845 terms (f has 495), computed in ... ms; matches f(p) (f(p) + 1) at p = (1, 2, -1, 3)? Yes
 ```
 
 ---
@@ -149,7 +2065,7 @@ Evaluation of sum at x = 2: 62
 
 3. **Evaluating at \(x = 2\)**:
    \[
-   4(2^3) + 3(2^2) + 2(2) + 6 = 32 + 12 + 4 + 6 = 62
+   4(2^3) + 3(2^2) + 2(2) + 6 = 32 + 12 + 4 + 6 = 54
    \]
 
 ---
@@ -5,6 +5,28 @@ cpp
 Copy code
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <bit>
+#include <memory>
+#include <optional>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <charconv>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
 using namespace std;
 
 struct Member {
@@ -22,10 +44,318 @@ struct Member {
     }
 };
 
+// Slab allocator for Member nodes. Nodes are carved from slabs that double in size
+// (64 nodes up to 4096), deleted nodes go on a free list for the next add, and
+// all slabs are freed together when the arena goes away. A club under churn thus
+// reuses its own memory instead of fragmenting the heap with one block per member.
+class MemberArena {
+public:
+    MemberArena() = default;
+    MemberArena(const MemberArena&) = delete;
+    MemberArena& operator=(const MemberArena&) = delete;
+
+    Member* create(int prn, const string& name, const string& ay) {
+        Slot* slot = freeList;
+        if (slot) {
+            freeList = slot->nextFree;
+        } else {
+            if (slabs.empty() || usedInLast == slabs.back().size) {
+                size_t size = slabs.empty() ? 64 : min<size_t>(2 * slabs.back().size, 4096);
+                slabs.push_back({make_unique<Slot[]>(size), size});
+                usedInLast = 0;
+            }
+            slot = &slabs.back().slots[usedInLast++];
+        }
+        return new (slot->storage) Member(prn, name, ay);
+    }
+
+    // Destroy a member and keep its slot for reuse
+    void destroy(Member* member) {
+        member->~Member();
+        Slot* slot = reinterpret_cast<Slot*>(member);
+        slot->nextFree = freeList;
+        freeList = slot;
+    }
+
+    // Take over all of other's slabs and free slots, leaving it empty. Nodes keep
+    // their addresses, so lists built in other stay valid here.
+    void absorb(MemberArena& other) {
+        if (other.slabs.empty()) return;
+        // Other's never-used slots join its free list, so that only our own last
+        // slab is ever bump-allocated from
+        Slab& last = other.slabs.back();
+        for (size_t i = other.usedInLast; i < last.size; ++i) {
+            last.slots[i].nextFree = other.freeList;
+            other.freeList = &last.slots[i];
+        }
+        if (other.freeList) {
+            Slot* end = other.freeList;
+            while (end->nextFree) end = end->nextFree;
+            end->nextFree = freeList;
+            freeList = other.freeList;
+        }
+        bool hadSlabs = !slabs.empty();
+        slabs.insert(slabs.begin(), make_move_iterator(other.slabs.begin()), make_move_iterator(other.slabs.end()));
+        if (!hadSlabs) usedInLast = slabs.back().size;
+        other.slabs.clear();
+        other.freeList = nullptr;
+        other.usedInLast = 0;
+    }
+
+    size_t slabCount() const { return slabs.size(); }
+
+private:
+    union Slot {
+        Slot* nextFree;
+        alignas(Member) unsigned char storage[sizeof(Member)];
+    };
+    struct Slab {
+        unique_ptr<Slot[]> slots;
+        size_t size;
+    };
+    vector<Slab> slabs;
+    size_t usedInLast = 0;  // Slots handed out from slabs.back()
+    Slot* freeList = nullptr;
+};
+
+// Where a member sits in a Club: its node and the node before it (nullptr for the head)
+struct MemberLink {
+    Member* node;
+    Member* prev;
+};
+
+// Where a member sits in a ClubColumns store
+struct MemberRow {
+    uint32_t row;
+};
+
+// Hash index from PRN to where a member is stored (a MemberLink or a MemberRow),
+// so a member can be found, updated and removed without a scan.
+// Open addressing with linear probing over a power-of-two table, grown at half
+// load; erase shifts later entries of the probe run back instead of leaving
+// tombstones, so lookups never slow down under churn.
+template <typename Location>
+class PrnIndex {
+public:
+    struct Entry : Location {
+        int prn;
+        bool occupied;  // false marks an empty slot
+    };
+
+    Entry* find(int prn) {
+        if (slots.empty()) return nullptr;
+        for (size_t i = home(prn);; i = (i + 1) & mask()) {
+            if (!slots[i].occupied) return nullptr;
+            if (slots[i].prn == prn) return &slots[i];
+        }
+    }
+
+    const Entry* find(int prn) const { return const_cast<PrnIndex*>(this)->find(prn); }
+
+    // The PRN must not be present yet
+    void insert(int prn, Location location) {
+        if (2 * (used + 1) > slots.size()) grow();
+        size_t i = home(prn);
+        while (slots[i].occupied) i = (i + 1) & mask();
+        slots[i] = Entry{location, prn, true};
+        ++used;
+    }
+
+    void erase(int prn) {
+        Entry* entry = find(prn);
+        if (!entry) return;
+        size_t hole = entry - slots.data();
+        // Move back any later entry in the run whose home slot does not lie between
+        // the hole and its current position, so every entry stays reachable
+        for (size_t i = (hole + 1) & mask(); slots[i].occupied; i = (i + 1) & mask()) {
+            size_t h = home(slots[i].prn);
+            if (((i - h) & mask()) >= ((i - hole) & mask())) {
+                slots[hole] = slots[i];
+                hole = i;
+            }
+        }
+        slots[hole].occupied = false;
+        --used;
+    }
+
+    size_t size() const { return used; }
+
+private:
+    vector<Entry> slots;
+    size_t used = 0;
+    int bits = 0;  // slots.size() == 2^bits
+
+    size_t mask() const { return slots.size() - 1; }
+
+    size_t home(int prn) const {  // Fibonacci hashing: consecutive PRNs spread over the table
+        return (uint32_t(prn) * 2654435769u) >> (32 - bits);
+    }
+
+    void grow() {
+        vector<Entry> old = move(slots);
+        slots.assign(max<size_t>(16, 2 * old.size()), Entry{});
+        bits = countr_zero(slots.size());
+        used = 0;
+        for (const Entry& e : old) {
+            if (e.occupied) insert(e.prn, e);
+        }
+    }
+};
+
+// Layouts for exporting a roster: the displayMembers() text, CSV with a header
+// row, or binary (a uint32 member count, then per member an int32 PRN and the
+// name and A.Y each as a uint32 length and bytes, all in host byte order)
+enum class RosterFormat { Text, Csv, Binary };
+
+// Formats a roster into a fixed buffer and hands it to write() whenever it fills,
+// so dumping many members costs a few large system calls instead of a flush per
+// row. Numbers go through to_chars, so formatting a row never allocates.
+class RosterWriter {
+public:
+    explicit RosterWriter(int fd, size_t capacity = 1 << 16)
+        : fd(fd), buffer(make_unique<char[]>(max<size_t>(capacity, 32))), capacity(max<size_t>(capacity, 32)) {}
+    RosterWriter(const RosterWriter&) = delete;
+    RosterWriter& operator=(const RosterWriter&) = delete;
+    ~RosterWriter() { flush(); }
+
+    // What comes before the first member
+    void header(RosterFormat format, size_t members) {
+        switch (format) {
+        case RosterFormat::Text: append("Club Members:\n"); break;
+        case RosterFormat::Csv: append("prn,name,ay\n"); break;
+        case RosterFormat::Binary: appendRaw(uint32_t(members)); break;
+        }
+    }
+
+    void member(int prn, string_view name, string_view ay, RosterFormat format) {
+        switch (format) {
+        case RosterFormat::Text:
+            append("PRN: ");
+            appendNumber(prn);
+            append(", Name: ");
+            append(name);
+            append(", A.Y: ");
+            append(ay);
+            append("\n");
+            break;
+        case RosterFormat::Csv:
+            appendNumber(prn);
+            append(",");
+            appendCsvField(name);
+            append(",");
+            appendCsvField(ay);
+            append("\n");
+            break;
+        case RosterFormat::Binary:
+            appendRaw(int32_t(prn));
+            appendRaw(uint32_t(name.size()));
+            append(name);
+            appendRaw(uint32_t(ay.size()));
+            append(ay);
+            break;
+        }
+    }
+
+    // Write out everything buffered; false once any write has failed
+    bool flush() {
+        for (size_t done = 0; done < used && ok;) {
+            ssize_t n = ::write(fd, buffer.get() + done, used - done);
+            if (n < 0) {
+                if (errno != EINTR) ok = false;
+                continue;
+            }
+            done += n;
+            ++writes;
+        }
+        used = 0;
+        return ok;
+    }
+
+    size_t writeCalls() const { return writes; }
+
+private:
+    void append(string_view text) {
+        while (text.size() > capacity - used) {
+            size_t part = capacity - used;
+            memcpy(buffer.get() + used, text.data(), part);
+            used += part;
+            text.remove_prefix(part);
+            flush();
+        }
+        memcpy(buffer.get() + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void appendNumber(int value) {
+        if (capacity - used < 11) flush();  // Room for "-2147483648"
+        used = to_chars(buffer.get() + used, buffer.get() + capacity, value).ptr - buffer.get();
+    }
+
+    template <typename T>
+    void appendRaw(T value) {
+        append(string_view(reinterpret_cast<const char*>(&value), sizeof value));
+    }
+
+    // Quote a field that contains a separator, quote or line break, doubling its quotes
+    void appendCsvField(string_view field) {
+        auto special = [](char c) { return c == ',' || c == '"' || c == '\r' || c == '\n'; };
+        if (none_of(field.begin(), field.end(), special)) {
+            append(field);
+            return;
+        }
+        append("\"");
+        for (size_t quote; (quote = field.find('"')) != string_view::npos; field.remove_prefix(quote + 1)) {
+            append(field.substr(0, quote + 1));
+            append("\"");
+        }
+        append(field);
+        append("\"");
+    }
+
+    int fd;
+    unique_ptr<char[]> buffer;
+    size_t capacity;
+    size_t used = 0;
+    size_t writes = 0;  // write() calls made
+    bool ok = true;
+};
+
+// Running totals for the members of one academic year
+struct YearStats {
+    int members = 0;
+    long long prnSum = 0;  // Mean PRN is prnSum / members
+};
+
 class Club {
 private:
     Member* head;  // Points to the first member
     Member* tail;  // Points to the last member
+    PrnIndex<MemberLink> index;  // PRN -> node and predecessor, for O(1) lookup, update and delete
+    MemberArena arena;  // Storage for this club's nodes
+    int count = 0;  // Number of members, kept up to date on every change
+    map<string, YearStats> years;  // Totals per academic year, likewise
+
+    // Add (sign 1) or remove (sign -1) a member from the running totals
+    void track(const Member* member, int sign) {
+        auto it = years.try_emplace(member->ay).first;
+        it->second.members += sign;
+        it->second.prnSum += sign * static_cast<long long>(member->prn);
+        if (it->second.members == 0) years.erase(it);
+        count += sign;
+    }
+
+    // Unlink an indexed member and fix up the index entry of the member after it
+    void unlink(PrnIndex<MemberLink>::Entry* entry) {
+        Member* node = entry->node;
+        track(node, -1);
+        Member* prev = entry->prev;
+        if (prev) prev->next = node->next;
+        else head = node->next;
+        if (node == tail) tail = prev;
+        if (node->next) index.find(node->next->prn)->prev = prev;
+        index.erase(node->prn);
+        arena.destroy(node);
+    }
 
 public:
     Club() {
@@ -33,9 +363,19 @@ public:
         tail = nullptr;
     }
 
-    // Function to add a member (or coordinator)
+    Club(const Club&) = delete;  // Owns its nodes
+    Club& operator=(const Club&) = delete;
+
+    // Function to add a member (or coordinator). PRNs identify members, so a PRN
+    // that is already in the club is rejected.
     void addMember(int prn, string name, string ay) {
-        Member* newMember = new Member(prn, name, ay);
+        if (index.find(prn)) {
+            cout << "Member with PRN " << prn << " already exists.\n";
+            return;
+        }
+        Member* newMember = arena.create(prn, name, ay);
+        index.insert(prn, {newMember, tail});
+        track(newMember, 1);
 
         // If list is empty, new member becomes head and tail
         if (!head) {
@@ -53,46 +393,59 @@ public:
             return;
         }
 
-        // If the head is the one to be deleted
-        if (head->prn == prn) {
-            Member* temp = head;
-            head = head->next;
-            delete temp;
-            cout << "Member with PRN " << prn << " deleted.\n";
+        if (!removeMember(prn)) {
+            cout << "Member with PRN " << prn << " not found.\n";
             return;
         }
+        cout << "Member with PRN " << prn << " deleted.\n";
+    }
 
-        // Traverse the list to find the member to delete
-        Member* current = head;
-        Member* prev = nullptr;
-        while (current && current->prn != prn) {
-            prev = current;
-            current = current->next;
-        }
+    // Delete a member without printing; returns whether the PRN was present
+    bool removeMember(int prn) {
+        PrnIndex<MemberLink>::Entry* entry = index.find(prn);
+        if (!entry) return false;
+        unlink(entry);
+        return true;
+    }
 
-        if (!current) {
-            cout << "Member with PRN " << prn << " not found.\n";
-            return;
+    // Function to find a member by PRN (nullptr if absent)
+    const Member* findMember(int prn) const {
+        const PrnIndex<MemberLink>::Entry* entry = index.find(prn);
+        return entry ? entry->node : nullptr;
+    }
+
+    // Reference lookup by walking the list, for comparison with findMember()
+    const Member* findMemberLinear(int prn) const {
+        for (Member* temp = head; temp; temp = temp->next) {
+            if (temp->prn == prn) return temp;
         }
+        return nullptr;
+    }
 
-        // Delete the member
-        prev->next = current->next;
-        if (current == tail)  // If deleting the tail member
-            tail = prev;
+    // Function to compute total members, from the running count
+    int totalMembers() const { return count; }
 
-        delete current;
-        cout << "Member with PRN " << prn << " deleted.\n";
+    // Totals for one academic year (all zero if nobody is in it)
+    YearStats yearStats(const string& ay) const {
+        auto it = years.find(ay);
+        return it == years.end() ? YearStats() : it->second;
     }
 
-    // Function to compute total members
-    int totalMembers() const {
-        int count = 0;
-        Member* temp = head;
-        while (temp) {
-            count++;
-            temp = temp->next;
+    // PRNs of all members of an academic year, in list order
+    vector<int> membersInYear(const string& ay) const {
+        vector<int> result;
+        for (Member* temp = head; temp; temp = temp->next) {
+            if (temp->ay == ay) result.push_back(temp->prn);
+        }
+        return result;
+    }
+
+    // Function to display the member count and mean PRN of every academic year
+    void displayYearStats() const {
+        for (const auto& [ay, stats] : years) {
+            cout << "A.Y: " << ay << ", Members: " << stats.members
+                 << ", Mean PRN: " << stats.prnSum / stats.members << endl;
         }
-        return count;
     }
 
     // Function to display all members
@@ -102,54 +455,424 @@ public:
             return;
         }
 
-        Member* temp = head;
-        cout << "Club Members:\n";
-        while (temp) {
-            cout << "PRN: " << temp->prn << ", Name: " << temp->name
-                 << ", A.Y: " << temp->ay << endl;
-            temp = temp->next;
+        cout.flush();  // Keep earlier output ahead of the rows
+        RosterWriter out(STDOUT_FILENO);
+        exportMembers(out, RosterFormat::Text);
+    }
+
+    // Function to write all members to a buffered writer; returns whether every
+    // write succeeded
+    bool exportMembers(RosterWriter& out, RosterFormat format) const {
+        out.header(format, count);
+        for (Member* temp = head; temp; temp = temp->next) {
+            out.member(temp->prn, temp->name, temp->ay, format);
         }
+        return out.flush();
     }
 
-    // Function to concatenate another club's members list
+    // Function to concatenate another club's members list. The other club's members
+    // move into this club's index; any whose PRN is already here are dropped.
     void concatenate(Club& other) {
         if (!other.head) return;  // If other list is empty, do nothing
+        Member* first = nullptr;  // The other list minus dropped members
+        Member* last = nullptr;
+        for (Member* node = other.head; node;) {
+            Member* next = node->next;
+            if (index.find(node->prn)) {
+                cout << "Member with PRN " << node->prn << " already exists, dropped.\n";
+                other.track(node, -1);
+                other.arena.destroy(node);
+            } else {
+                index.insert(node->prn, {node, last ? last : tail});
+                if (last) last->next = node;
+                else first = node;
+                last = node;
+            }
+            node = next;
+        }
+        if (last) last->next = nullptr;
+        other.head = other.tail = nullptr;  // Clear the other list
+        other.index = PrnIndex<MemberLink>();
+        arena.absorb(other.arena);  // The moved nodes live in other's slabs
+        // Totals merge per academic year, not per member
+        count += other.count;
+        for (const auto& [ay, stats] : other.years) {
+            YearStats& mine = years[ay];
+            mine.members += stats.members;
+            mine.prnSum += stats.prnSum;
+        }
+        other.count = 0;
+        other.years.clear();
+        if (!first) return;
+
         if (!head) {  // If current list is empty, point to other list
-            head = other.head;
-            tail = other.tail;
+            head = first;
         } else {
-            tail->next = other.head;  // Link the tail of this list to other's head
-            tail = other.tail;  // Update the tail pointer
+            tail->next = first;  // Link the tail of this list to other's head
         }
-        other.head = other.tail = nullptr;  // Clear the other list
+        tail = last;  // Update the tail pointer
     }
 
     // Function to update member information based on PRN
     void updateMember(int prn, string newName, string newAY) {
-        Member* temp = head;
-        while (temp) {
-            if (temp->prn == prn) {
-                temp->name = newName;
-                temp->ay = newAY;
-                cout << "Member with PRN " << prn << " updated.\n";
-                return;
-            }
-            temp = temp->next;
+        PrnIndex<MemberLink>::Entry* entry = index.find(prn);
+        if (!entry) {
+            cout << "Member with PRN " << prn << " not found.\n";
+            return;
+        }
+        entry->node->name = newName;
+        if (entry->node->ay != newAY) {
+            track(entry->node, -1);
+            entry->node->ay = newAY;
+            track(entry->node, 1);
         }
-        cout << "Member with PRN " << prn << " not found.\n";
+        cout << "Member with PRN " << prn << " updated.\n";
     }
 
-    // Destructor to free memory
+    // Destructor to free memory: each member's strings are destroyed, then the
+    // arena releases all node storage at once
     ~Club() {
         Member* temp;
         while (head) {
             temp = head;
             head = head->next;
-            delete temp;
+            temp->~Member();
+        }
+    }
+};
+
+// Write to rows (room for n entries) the indices i < n with column[i] == value,
+// in order; returns how many were written
+size_t matchRowsScalar(const int* column, size_t n, int value, uint32_t* rows) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        rows[count] = i;
+        count += column[i] == value;  // No branch to mispredict
+    }
+    return count;
+}
+
+#ifdef HAVE_X86_SIMD
+// Compare eight entries per instruction and only look at the ones that matched
+__attribute__((target("avx2")))
+size_t matchRowsAvx2(const int* column, size_t n, int value, uint32_t* rows) {
+    const __m256i target = _mm256_set1_epi32(value);
+    size_t i = 0, count = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, target)));
+        for (; mask; mask &= mask - 1) rows[count++] = i + __builtin_ctz(mask);
+    }
+    size_t tail = matchRowsScalar(column + i, n - i, value, rows + count);
+    for (size_t k = count; k < count + tail; ++k) rows[k] += i;
+    return count + tail;
+}
+#endif
+
+// Pick the widest kernel the CPU supports, once per process
+size_t matchRows(const int* column, size_t n, int value, uint32_t* rows) {
+    using Kernel = size_t (*)(const int*, size_t, int, uint32_t*);
+    static const Kernel kernel = [] {
+#ifdef HAVE_X86_SIMD
+        if (__builtin_cpu_supports("avx2")) return Kernel(matchRowsAvx2);
+#endif
+        return Kernel(matchRowsScalar);
+    }();
+    return kernel(column, n, value, rows);
+}
+
+// Column-oriented club: one array per field instead of one node per member, so a
+// scan by academic year reads only the column it tests. Names are stored back to
+// back in one string, and each academic year is stored once in a small
+// dictionary, with rows holding its id. A PrnIndex maps PRNs to rows.
+// Rows keep insertion order, like Club, so a removed member leaves a tombstone
+// row (year id -1) rather than shifting every later row; once tombstones
+// outnumber live rows, the columns are compacted in one pass. Row numbers are
+// therefore only valid until the next removeMember().
+class ClubColumns {
+public:
+    // Function to add a member; a PRN that is already in the club is rejected
+    bool addMember(int prn, string_view name, string_view ay) {
+        if (index.find(prn)) return false;
+        index.insert(prn, {uint32_t(prns.size())});
+        prns.push_back(prn);
+        years.push_back(yearId(ay));
+        nameStart.push_back(names.size());
+        nameLength.push_back(name.size());
+        names.append(name);
+        return true;
+    }
+
+    // Function to delete a member by PRN; returns whether the PRN was present
+    bool removeMember(int prn) {
+        long row = findRow(prn);
+        if (row < 0) return false;
+        index.erase(prn);
+        years[row] = -1;
+        deadNameBytes += nameLength[row];
+        ++deadRows;
+        compactIfSparse();
+        return true;
+    }
+
+    // Function to update member information by PRN; the new name is appended to
+    // the name storage and the old one becomes garbage until the next compaction
+    bool updateMember(int prn, string_view newName, string_view newAY) {
+        long row = findRow(prn);
+        if (row < 0) return false;
+        deadNameBytes += nameLength[row];
+        nameStart[row] = names.size();
+        nameLength[row] = newName.size();
+        names.append(newName);
+        years[row] = yearId(newAY);
+        compactIfSparse();
+        return true;
+    }
+
+    int totalMembers() const { return prns.size() - deadRows; }
+
+    // Function to find a member's row by PRN (-1 if absent), through the index
+    long findRow(int prn) const {
+        const PrnIndex<MemberRow>::Entry* entry = index.find(prn);
+        return entry ? long(entry->row) : -1;
+    }
+
+    int prnAt(size_t row) const { return prns[row]; }
+    string_view nameAt(size_t row) const { return string_view(names).substr(nameStart[row], nameLength[row]); }
+    const string& yearAt(size_t row) const { return yearNames[years[row]]; }
+
+    // PRNs of all members of an academic year, in insertion order, found by
+    // scanning the year-id column (tombstones never match)
+    vector<int> membersInYear(string_view ay) const {
+        vector<int> result;
+        auto it = find(yearNames.begin(), yearNames.end(), ay);
+        if (it == yearNames.end()) return result;
+        vector<uint32_t> rows(years.size());
+        rows.resize(matchRows(years.data(), years.size(), it - yearNames.begin(), rows.data()));
+        result.reserve(rows.size());
+        for (uint32_t row : rows) result.push_back(prns[row]);
+        return result;
+    }
+
+    // Function to display all members
+    void displayMembers() const {
+        if (totalMembers() == 0) {
+            cout << "No members in the club.\n";
+            return;
         }
+        cout.flush();  // Keep earlier output ahead of the rows
+        RosterWriter out(STDOUT_FILENO);
+        exportMembers(out, RosterFormat::Text);
     }
+
+    // Function to write all members to a buffered writer; returns whether every
+    // write succeeded
+    bool exportMembers(RosterWriter& out, RosterFormat format) const {
+        out.header(format, totalMembers());
+        for (size_t row = 0; row < prns.size(); ++row) {
+            if (years[row] >= 0) out.member(prnAt(row), nameAt(row), yearAt(row), format);
+        }
+        return out.flush();
+    }
+
+private:
+    // Dictionary id of an academic year, adding it if new. Clubs see only a handful
+    // of distinct years, so a linear search beats hashing.
+    int yearId(string_view ay) {
+        auto it = find(yearNames.begin(), yearNames.end(), ay);
+        if (it != yearNames.end()) return it - yearNames.begin();
+        yearNames.emplace_back(ay);
+        return yearNames.size() - 1;
+    }
+
+    // Drop tombstone rows once they outnumber live rows, and stale names once they
+    // make up more than half the name storage. Live rows keep their order and the
+    // index is pointed at their new positions, so each removal costs O(1) amortized.
+    void compactIfSparse() {
+        if (deadRows <= prns.size() - deadRows && deadNameBytes <= names.size() / 2) return;
+        string packed;
+        packed.reserve(names.size() - deadNameBytes);
+        size_t kept = 0;
+        for (size_t row = 0; row < prns.size(); ++row) {
+            if (years[row] < 0) continue;
+            uint32_t start = packed.size();
+            packed.append(nameAt(row));
+            prns[kept] = prns[row];
+            years[kept] = years[row];
+            nameStart[kept] = start;
+            nameLength[kept] = nameLength[row];
+            index.find(prns[kept])->row = kept;
+            ++kept;
+        }
+        prns.resize(kept);
+        years.resize(kept);
+        nameStart.resize(kept);
+        nameLength.resize(kept);
+        names = move(packed);
+        deadRows = 0;
+        deadNameBytes = 0;
+    }
+
+    vector<int> prns;
+    vector<int> years;  // Year dictionary ids, -1 for a removed row
+    vector<uint32_t> nameStart;  // Name of row r is names[nameStart[r] .. + nameLength[r])
+    vector<uint32_t> nameLength;
+    string names;
+    size_t deadRows = 0;  // Tombstone rows not compacted away yet
+    size_t deadNameBytes = 0;  // Bytes of names no live row refers to any more
+    vector<string> yearNames;  // Dictionary id -> academic year
+    PrnIndex<MemberRow> index;  // PRN -> row
 };
 
+// Heap allocations made so far, for comparing node storage strategies
+size_t allocationCount = 0;
+
+// Not inlined, so the compiler never sees new-allocated memory reach free() directly
+__attribute__((noinline)) void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// Build a club, replace a quarter of its members, then tear it down, and do the
+// same with one new / delete per member as a plain linked list would. Reports the
+// heap allocations and the teardown time of both.
+void benchmarkArena(int members = 200000) {
+    vector<int> prns(members);
+    for (int i = 0; i < members; ++i) prns[i] = 100000 + i;
+    shuffle(prns.begin(), prns.end(), mt19937(2));
+    auto millisecondsSince = [](chrono::steady_clock::time_point begin) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    };
+
+    vector<Member*> nodes;
+    nodes.reserve(members);
+    size_t before = allocationCount;
+    for (int prn : prns) nodes.push_back(new Member(prn, "Member", "2023-24"));
+    for (int i = 0; i < members / 4; ++i) {
+        delete nodes[i];
+        nodes[i] = new Member(prns[i], "Renamed", "2024-25");
+    }
+    size_t plainAllocations = allocationCount - before;
+    auto begin = chrono::steady_clock::now();
+    for (Member* node : nodes) delete node;
+    double plainTeardown = millisecondsSince(begin);
+
+    optional<Club> club(in_place);
+    before = allocationCount;
+    for (int prn : prns) club->addMember(prn, "Member", "2023-24");
+    for (int i = 0; i < members / 4; ++i) {
+        club->removeMember(prns[i]);
+        club->addMember(prns[i], "Renamed", "2024-25");
+    }
+    size_t arenaAllocations = allocationCount - before;
+    begin = chrono::steady_clock::now();
+    club.reset();
+    double arenaTeardown = millisecondsSince(begin);
+
+    cout << members << " members with " << members / 4 << " replaced: " << plainAllocations
+         << " heap allocations one node at a time, " << arenaAllocations << " with the arena (index included); teardown "
+         << plainTeardown << " ms vs " << arenaTeardown << " ms" << endl;
+}
+
+// Time PRN lookups through the index against walking the list, in a club whose
+// members were added in shuffled PRN order
+void benchmarkLookups(int members = 100000, int lookups = 2000) {
+    Club club;
+    vector<int> prns(members);
+    for (int i = 0; i < members; ++i) prns[i] = 100000 + i;
+    mt19937 rng(1);
+    shuffle(prns.begin(), prns.end(), rng);
+    for (int prn : prns) club.addMember(prn, "Member", "2023-24");
+
+    vector<int> queries(lookups);
+    for (int& q : queries) q = prns[rng() % members];
+    auto time = [&](auto find) {
+        auto begin = chrono::steady_clock::now();
+        int found = 0;
+        for (int q : queries) found += find(q) != nullptr;
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count() / lookups;
+        return make_pair(us, found);
+    };
+    auto [linearUs, linearFound] = time([&](int prn) { return club.findMemberLinear(prn); });
+    auto [indexUs, indexFound] = time([&](int prn) { return club.findMember(prn); });
+    cout << "PRN lookups among " << members << " members: linear scan " << linearUs << " us, index "
+         << indexUs << " us per lookup (" << linearFound << " and " << indexFound << " found)" << endl;
+}
+
+// Time building, churning and an academic-year filter on the list-based club and on
+// the columns, with members spread over eight academic years
+void benchmarkColumns(int members = 200000, int queries = 20) {
+    vector<string> years;
+    for (int y = 0; y < 8; ++y) years.push_back(to_string(2016 + y) + "-" + to_string(17 + y));
+    vector<int> prns(members);
+    for (int i = 0; i < members; ++i) prns[i] = 100000 + i;
+    mt19937 rng(3);
+    shuffle(prns.begin(), prns.end(), rng);
+    vector<int> yearOf(members);
+    for (int& y : yearOf) y = rng() % years.size();
+    auto millisecondsToFill = [&](auto& store) {
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < members; ++i) store.addMember(prns[i], "Member " + to_string(i), years[yearOf[i]]);
+        for (int i = 0; i < members; i += 2) store.removeMember(prns[i]);  // Churn: half leave and rejoin
+        for (int i = 0; i < members; i += 2) store.addMember(prns[i], "Member " + to_string(i), years[yearOf[i]]);
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    };
+    Club club;
+    ClubColumns columns;
+    double listFillMs = millisecondsToFill(club);
+    double columnFillMs = millisecondsToFill(columns);
+
+    auto time = [&](auto query) {
+        auto begin = chrono::steady_clock::now();
+        size_t found = 0;
+        for (int q = 0; q < queries; ++q) found += query(q);
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count() / queries;
+        return make_pair(us, found);
+    };
+    auto [listYearUs, listYear] = time([&](int q) { return club.membersInYear(years[q % years.size()]).size(); });
+    auto [columnYearUs, columnYear] = time([&](int q) { return columns.membersInYear(years[q % years.size()]).size(); });
+    cout << members << " members: add, remove and re-add half: list " << listFillMs << " ms, columns " << columnFillMs
+         << " ms; A.Y filter list " << listYearUs << " us, columns " << columnYearUs << " us (" << listYear << " and "
+         << columnYear << " matches)" << endl;
+}
+
+// Dump a roster to /dev/null the old way, streaming each row with endl, and then
+// through RosterWriter in each format. Reports time, bytes and write() calls.
+void benchmarkExport(int members = 1000000) {
+    Club club;
+    for (int i = 0; i < members; ++i) club.addMember(100000 + i, "Member " + to_string(i), i % 2 ? "2023-24" : "2024-25");
+
+    auto millisecondsSince = [](chrono::steady_clock::time_point begin) {
+        return chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    };
+    ofstream stream("/dev/null");
+    auto begin = chrono::steady_clock::now();
+    for (int i = 0; i < members; ++i) {
+        stream << "PRN: " << 100000 + i << ", Name: " << "Member " + to_string(i)
+               << ", A.Y: " << (i % 2 ? "2023-24" : "2024-25") << endl;
+    }
+    cout << "Dumping " << members << " members: endl per row " << millisecondsSince(begin) << " ms";
+
+    int fd = open("/dev/null", O_WRONLY);
+    const pair<RosterFormat, const char*> formats[] = {
+        {RosterFormat::Text, "text"}, {RosterFormat::Csv, "CSV"}, {RosterFormat::Binary, "binary"}};
+    for (auto [format, label] : formats) {
+        RosterWriter out(fd);
+        begin = chrono::steady_clock::now();
+        club.exportMembers(out, format);
+        double ms = millisecondsSince(begin);
+        cout << "; buffered " << label << " " << ms << " ms (" << out.writeCalls() << " writes)";
+    }
+    close(fd);
+    cout << endl;
+}
+
 // Main function to test the Club class
 int main() {
     Club division1, division2;
@@ -187,6 +910,27 @@ int main() {
 
     // Display total members in Division 1
     cout << "\nTotal members in Division 1: " << division1.totalMembers() << endl;
+    division1.displayYearStats();
+
+    // PRNs identify members: a second member with PRN 101 is rejected
+    division1.addMember(101, "Eve", "2024-25");
+    cout << "PRN 202 belongs to " << division1.findMember(202)->name << endl;
+
+    // The same roster in the column-oriented store
+    ClubColumns columns;
+    for (int prn : {101, 102, 202}) {
+        const Member* member = division1.findMember(prn);
+        columns.addMember(member->prn, member->name, member->ay);
+    }
+    cout << "Members in A.Y 2023-24:";
+    for (int prn : columns.membersInYear("2023-24")) cout << " " << prn;
+    cout << endl;
+
+    // Lookups, updates and deletes go through the PRN index instead of a list walk
+    benchmarkLookups();
+    benchmarkArena();
+    benchmarkColumns();
+    benchmarkExport();
 
     return 0;
 }
@@ -194,20 +938,47 @@ Explanation:
 Struct Member:
 
 Stores PRN, name, academic year, and a pointer to the next member.
+Class PrnIndex:
+
+Hash table from PRN to where a member is stored: its node and the node before it for Club (MemberLink), or its row for ClubColumns (MemberRow). It uses open addressing with linear probing.
+Erasing shifts later entries back instead of leaving tombstones, so lookups stay fast under heavy churn.
+Class RosterWriter:
+
+Formats members into a 64 KB buffer with to_chars and hands it to write() on a file descriptor whenever it fills, instead of flushing after every row.
+RosterFormat picks the layout: the displayed text, CSV (fields with commas, quotes or line breaks are quoted), or binary (a member count, then each PRN with length-prefixed name and A.Y).
+Class MemberArena:
+
+Slab allocator for member nodes: slabs of 64 nodes doubling up to 4096, with deleted nodes kept on a free list for the next add.
+absorb() takes over another arena's slabs and free slots, so nodes moved between clubs keep their addresses.
 Class Club:
 
 head points to the first member, and tail points to the last member.
 Supports operations:
-addMember(): Adds a new member at the end of the list.
-deleteMember(): Deletes a member by PRN.
-totalMembers(): Counts the total number of members.
-displayMembers(): Displays all members.
-concatenate(): Concatenates two club lists.
-updateMember(): Updates a member’s information.
-Destructor to free memory at the end.
+addMember(): Adds a new member at the end of the list (PRNs are unique; a duplicate is rejected).
+deleteMember(): Deletes a member by PRN, finding it and its predecessor through the index in O(1); removeMember() does the same silently and reports whether the PRN was present.
+findMember(): Looks up a member by PRN through the index; findMemberLinear() walks the list for comparison.
+totalMembers(): Returns the member count, which is kept up to date by every add, delete and concatenation instead of being counted by walking the list.
+yearStats() / displayYearStats(): Member count and PRN sum (for the mean PRN) per academic year, likewise maintained on every change.
+displayMembers(): Displays all members, writing them to standard output through a RosterWriter.
+exportMembers(): Writes all members to a RosterWriter in any RosterFormat, reporting whether every write succeeded.
+concatenate(): Concatenates two club lists, moving the other club's members into the index (members whose PRN is already present are dropped) and taking over the other club's arena; counts and per-year totals are merged per year rather than per member.
+updateMember(): Updates a member’s information, found through the index.
+membersInYear(): PRNs of all members of an academic year, by walking the list.
+Destructor destroys each member, then the arena frees all node storage at once.
+Class ClubColumns:
+
+Column-oriented alternative to Club: PRNs and academic-year ids in contiguous int arrays, all names back to back in one string, and each academic year stored once in a small dictionary.
+findRow() goes through a PrnIndex from PRN to row, so adding, updating and removing a member cost O(1) (amortized).
+membersInYear() scans only the year-id column, eight entries per compare where AVX2 is available (matchRows() picks the kernel at run time).
+Rows stay in insertion order: a removed member leaves a tombstone row that the scans skip, and once tombstones outnumber live rows the columns are compacted in one pass. Replaced names are likewise dropped once they fill more than half the name storage.
+displayMembers() and exportMembers() work as in Club.
 main() Function:
 
 Demonstrates adding, displaying, concatenating, updating, and deleting members.
+benchmarkLookups() times PRN lookups through the index against a linear scan of the list.
+benchmarkArena() counts heap allocations and times teardown for a club under churn, against one new / delete per member.
+benchmarkColumns() times filling a store with churn and an academic-year filter on Club against ClubColumns.
+benchmarkExport() dumps a million members to /dev/null with endl per row, then through RosterWriter as text, CSV and binary.
 Sample Output:
 yaml
 Copy code
@@ -241,6 +1012,15 @@ PRN: 102, Name: Bobby, A.Y: 2024-25
 PRN: 202, Name: David, A.Y: 2023-24
 
 Total members in Division 1: 3
+A.Y: 2023-24, Members: 2, Mean PRN: 151
+A.Y: 2024-25, Members: 1, Mean PRN: 102
+Member with PRN 101 already exists.
+PRN 202 belongs to David
+Members in A.Y 2023-24: 101 202
+PRN lookups among 100000 members: linear scan ... us, index ... us per lookup (2000 and 2000 found)
+200000 members with 50000 replaced: 250000 heap allocations one node at a time, 79 with the arena (index included); teardown ... ms vs ... ms
+200000 members: add, remove and re-add half: list ... ms, columns ... ms; A.Y filter list ... us, columns ... us (499958 and 499958 matches)
+Dumping 1000000 members: endl per row ... ms; buffered text ... ms (718 writes); buffered CSV ... ms (443 writes); buffered binary ... ms (487 writes)
 Conclusion:
 This C++ program maintains club members' information using singly linked lists. It allows adding, deleting, displaying, counting, updating, and concatenating member lists, demonstrating the flexibility of linked lists.
 